@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file           : fixed_format.h
+  * @brief          : Fixed-point number formatting for the display paths
+  ******************************************************************************
+  * Replaces sprintf on the measurement tick. Values are integers with a given
+  * number of decimal digits after the point, rounded half away from zero to
+  * the digits shown, and appended to a caller buffer with a minimum width,
+  * blank or zero padding and a sign. Nothing is allocated. Rounding adds
+  * half a unit and the digits are produced by subtracting powers of ten, so
+  * nothing is divided, as the Cortex-M0+ has no divide instruction.
+  ******************************************************************************
+  */
+
+#ifndef __FIXED_FORMAT_H
+#define __FIXED_FORMAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FORMAT_MAX_DECIMALS     6       // Fraction digits of a value or of its output
+
+// Flags of Format_Fixed and Format_Int
+#define FORMAT_ZERO_PAD         0x01    // Pad with zeros after the sign instead of leading blanks
+#define FORMAT_LEFT             0x02    // Pad with trailing blanks
+#define FORMAT_PLUS             0x04    // Sign positive values with '+'
+
+typedef struct {
+    char* text;         // Always terminated, output past the end is dropped
+    uint8_t size;       // Bytes of text, terminator included
+    uint8_t length;
+} Format_Buffer_t;
+
+void Format_Begin(Format_Buffer_t* out, char* text, uint8_t size);
+void Format_Char(Format_Buffer_t* out, char c);
+void Format_Text(Format_Buffer_t* out, const char* text);
+void Format_Pad(Format_Buffer_t* out, uint8_t column);
+void Format_Fixed(Format_Buffer_t* out, int32_t value, uint8_t scale, uint8_t decimals,
+                  uint8_t width, uint8_t flags);
+void Format_Int(Format_Buffer_t* out, int32_t value, uint8_t width, uint8_t flags);
+int32_t Format_From_Float(float value, uint8_t decimals);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FIXED_FORMAT_H */
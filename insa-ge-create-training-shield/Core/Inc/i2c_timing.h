@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file           : i2c_timing.h
+  * @brief          : I2C bus speed profiles for the display bus
+  ******************************************************************************
+  * The TIMINGR value of each profile is computed at run time from the I2C
+  * kernel clock, itself derived from SystemCoreClock, so changing the clock
+  * tree no longer leaves a stale CubeMX constant behind. The computation
+  * follows the reference manual: SCL low/high times and data setup/hold
+  * delays are kept above the I2C specification minimums for the mode.
+  ******************************************************************************
+  */
+
+#ifndef __I2C_TIMING_H
+#define __I2C_TIMING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32l0xx_hal.h"
+
+// Bus edges estimated for the shield (short traces, display module pull-ups)
+#define I2C_TIMING_RISE_NS      100
+#define I2C_TIMING_FALL_NS      10
+
+typedef enum {
+    I2C_PROFILE_STANDARD = 0,   // 100 kHz Standard-mode
+    I2C_PROFILE_FAST,           // 400 kHz Fast-mode
+    I2C_PROFILE_FAST_PLUS,      // 1 MHz Fast-mode Plus, PB8/PB9 Fm+ drive enabled
+    I2C_PROFILE_COUNT
+} I2C_Profile_t;
+
+#define I2C_PROFILE_DEFAULT     I2C_PROFILE_FAST
+
+uint32_t I2C_Timing_Compute(uint32_t kernel_clock_hz, I2C_Profile_t profile);
+HAL_StatusTypeDef I2C_Timing_Apply(I2C_HandleTypeDef* hi2c, I2C_Profile_t profile);
+I2C_Profile_t I2C_Timing_Get_Profile(void);
+const char* I2C_Timing_Get_Name(I2C_Profile_t profile);
+uint32_t I2C_Timing_Get_Bus_Hz(I2C_Profile_t profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2C_TIMING_H */
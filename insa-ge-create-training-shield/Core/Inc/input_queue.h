@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file           : input_queue.h
+  * @brief          : Lock-free input event queues from the interrupts
+  ******************************************************************************
+  * Each input interrupt owns one queue and only pushes a timestamped sample of
+  * its pins; the measurement tick pops the events of all queues in time order
+  * and runs the menu logic, so the menu state has a single writer. A queue has
+  * one producer and one consumer: the producer alone writes the head and the
+  * consumer alone writes the tail, so neither side masks interrupts. A full
+  * queue drops the new event and counts it.
+  ******************************************************************************
+  */
+
+#ifndef __INPUT_QUEUE_H
+#define __INPUT_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define INPUT_QUEUE_SIZE    16    // Events per queue, a power of two
+
+typedef struct {
+    uint16_t time;      // Low 16 bits of the tick of the interrupt, see Input_Event_Time
+    uint8_t source;     // Application defined, e.g. the input that fired
+    uint8_t value;      // Pin levels read by the interrupt
+} Input_Event_t;
+
+typedef struct {
+    Input_Event_t events[INPUT_QUEUE_SIZE];
+    volatile uint8_t head;      // Next event to write, producer only
+    volatile uint8_t tail;      // Next event to read, consumer only
+    volatile uint16_t dropped;  // Events lost to a full queue, producer only
+} Input_Queue_t;
+
+uint8_t Input_Push(Input_Queue_t* queue, uint8_t source, uint8_t value, uint32_t now);
+const Input_Event_t* Input_Peek(const Input_Queue_t* queue);
+void Input_Pop(Input_Queue_t* queue);
+uint32_t Input_Event_Time(const Input_Event_t* event, uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INPUT_QUEUE_H */
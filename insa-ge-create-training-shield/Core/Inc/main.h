@@ -56,6 +56,7 @@ void Error_Handler(void);
 void Timer_Interrupt_Handler(void);
 void User_Button_Interrupt_Handler(void);
 void Rotary_Encoder_Interrupt_Handler(void);
+void Sampling_Timer_Interrupt_Handler(void);
 uint32_t Get_ADC_Value(uint32_t adc_channel);
 
 // Power meter simulation functions
@@ -72,6 +73,16 @@ void Handle_Menu_Navigation(int8_t direction);
 void Handle_Menu_Action(uint8_t press_type);
 void Display_Current_Menu(void);
 void Display_Power_Meter(void);
+void Display_Gauge(void);
+void Display_Big_Numbers(void);
+void Display_Graphics(void);
+void Display_Histogram(void);
+void Update_Graphics_Data(void);
+void Graphics_Zoom(int8_t direction);
+void Graphics_Pan(int8_t direction);
+void Display_Scope(void);
+void Scope_Adjust_Level(int8_t direction);
+void Display_Diagnostics(void);
 
 /* USER CODE END EFP */
 
@@ -91,6 +102,14 @@ void Display_Power_Meter(void);
 #define USER_BUTTON_EXTI_IRQn EXTI4_15_IRQn
 
 /* USER CODE BEGIN Private defines */
+// Rotary encoder decoding: 0 decodes the EXTI edges of ROT_CHA/ROT_CHB in
+// software, 1 counts them in hardware with TIM2 in encoder mode (PA0/PA1 on
+// AF2), read once per measurement tick without any interrupt
+#ifndef ROTARY_HW_ENCODER
+#define ROTARY_HW_ENCODER 0
+#endif
+#define ROTARY_COUNTS_PER_DETENT 4      // Quadrature edges between two detents
+#define ROTARY_INPUT_FILTER      0x0F   // TIM2 input filter: 8 samples at fDTS/32, 32 us at fDTS = 8 MHz
 
 /* USER CODE END Private defines */
 
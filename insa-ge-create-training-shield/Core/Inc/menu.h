@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : menu.h
+  * @brief          : Table-driven menu navigation and rendering
+  ******************************************************************************
+  * Every screen is a const descriptor in flash. A list screen names its items,
+  * each with a label, an optional value binding drawn after the label, an
+  * action and the screen it leads to; one navigator and one renderer serve
+  * all of them. Other screens provide their own draw, turn and press hooks
+  * and share the parent links, so a short press on a view or a Back item
+  * returns to the item that opened it.
+  ******************************************************************************
+  */
+
+#ifndef __MENU_H
+#define __MENU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "fixed_format.h"
+
+#define MENU_STAY           0xFF  // Item target: keep the current screen
+#define MENU_BACK           0xFE  // Item target: return to the parent screen
+#define MENU_VISIBLE_ITEMS  3     // List rows below the title
+
+typedef struct {
+    const char* label;
+    void (*value)(Format_Buffer_t* out);    // Appends the bound setting after the label, NULL for none
+    void (*action)(void);                   // Run on a short press before moving, NULL for none
+    uint8_t target;                         // Screen entered, MENU_STAY or MENU_BACK
+} Menu_Item_t;
+
+typedef struct {
+    const char* title;              // Title row of a list screen
+    const Menu_Item_t* items;       // NULL for a screen drawn by its hooks
+    uint8_t count;
+    uint8_t parent;                 // Screen of MENU_BACK and of a short press on a view
+    uint8_t parent_selection;       // Item selected on returning to the parent
+    void (*draw)(void);             // Draws a view, NULL for a list screen
+    void (*turn)(int8_t direction); // Encoder on a view, NULL when it does nothing
+    uint8_t (*press)(void);         // Short press on a view, returns 1 when handled
+} Menu_Screen_t;
+
+void Menu_Init(const Menu_Screen_t* screens, uint8_t count, uint8_t home);
+void Menu_Set_Screen(uint8_t screen, uint8_t selection);
+uint8_t Menu_Get_Screen(void);
+uint8_t Menu_Get_Selection(void);
+void Menu_Turn(int8_t direction);
+void Menu_Press(void);
+void Menu_Long_Press(void);
+void Menu_Draw(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MENU_H */
@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @file           : power_histogram.h
+  * @brief          : Incremental power distribution histogram
+  ******************************************************************************
+  * Every measurement increments one 32-bit counter, so recording is O(1) per
+  * sample. The distribution is always recorded at HISTOGRAM_BINS resolution;
+  * coarser views sum adjacent bins when they are read.
+  ******************************************************************************
+  */
+
+#ifndef __POWER_HISTOGRAM_H
+#define __POWER_HISTOGRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define HISTOGRAM_BINS          32    // Recorded bins, must be a power of two
+#define HISTOGRAM_MIN_BINS      8     // Coarsest view
+#define HISTOGRAM_FULL_SCALE_W  150   // Upper edge of the last bin (30V * 5A)
+
+void Histogram_Reset(void);
+void Histogram_Add(float power);
+uint32_t Histogram_Get_Total(void);
+uint32_t Histogram_Get_Count(uint8_t bin, uint8_t bins);
+uint32_t Histogram_Get_Max_Count(uint8_t bins);
+uint16_t Histogram_Get_Percentile(uint8_t percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __POWER_HISTOGRAM_H */
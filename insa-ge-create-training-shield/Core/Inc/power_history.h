@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file           : power_history.h
+  * @brief          : Multi-resolution measurement history for the graph screen
+  ******************************************************************************
+  * The history is kept as a pyramid of rings. Level 0 stores one bucket per
+  * base period, and every level above stores the mean of two buckets of the
+  * level below, giving decimation factors 1x, 2x, 4x ... 16x. Zoomed views
+  * read one ring directly, so a full graph never has to re-aggregate samples.
+  ******************************************************************************
+  */
+
+#ifndef __POWER_HISTORY_H
+#define __POWER_HISTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define HISTORY_LEVELS          5     // Decimation factors 1x, 2x, 4x ... 16x
+#define HISTORY_DEPTH           80    // Buckets kept per level (64 graph points + 16 of pan range)
+#define HISTORY_BASE_PERIOD_MS  200   // Time covered by one level 0 bucket
+
+// Fixed-point units of the stored values
+#define HISTORY_VOLTAGE_SCALE   100   // 10 mV per LSB
+#define HISTORY_CURRENT_SCALE   1000  // 1 mA per LSB
+#define HISTORY_POWER_SCALE     100   // 10 mW per LSB
+
+typedef struct {
+    uint16_t voltage;   // Voltage in 10 mV units
+    uint16_t current;   // Current in mA
+    uint16_t power;     // Power in 10 mW units
+} History_Sample_t;
+
+void History_Reset(void);
+void History_Push(float voltage, float current, float power, uint32_t timestamp);
+uint16_t History_Count(uint8_t level);
+const History_Sample_t* History_Get(uint8_t level, uint16_t age);
+uint32_t History_Get_Age_Ms(uint8_t level, uint16_t age, uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __POWER_HISTORY_H */
@@ -0,0 +1,39 @@
+/**
+  ******************************************************************************
+  * @file           : render_scheduler.h
+  * @brief          : Display frame rate governor
+  ******************************************************************************
+  * The measurement tick asks the scheduler whether a frame is due instead of
+  * drawing on every tick. Each screen has a target frame rate, or draws only
+  * when it changed. A periodic frame that falls due while the previous flush
+  * is still on the bus is skipped and counted as dropped, so a slow bus costs
+  * frames rather than measurement time.
+  ******************************************************************************
+  */
+
+#ifndef __RENDER_SCHEDULER_H
+#define __RENDER_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define RENDER_FPS_ON_CHANGE    0     // Target of screens that only draw when changed
+#define RENDER_FPS_WINDOW_MS    1000  // Averaging window of the achieved frame rate
+
+typedef struct {
+    uint16_t fps_x10;   // Achieved frame rate of the last window, 0.1 fps units
+    uint16_t dropped;   // Periodic frames skipped because a flush was in flight
+} Render_Stats_t;
+
+void Render_Init(const uint8_t* target_fps, Render_Stats_t* stats, uint8_t screens);
+uint8_t Render_Frame_Due(uint8_t screen, uint8_t changed, uint32_t now);
+void Render_Frame_Done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RENDER_SCHEDULER_H */
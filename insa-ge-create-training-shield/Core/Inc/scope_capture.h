@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file           : scope_capture.h
+  * @brief          : Triggered waveform capture with pre-trigger buffer
+  ******************************************************************************
+  * Raw ADC samples are written continuously into a ring while the capture is
+  * armed. Once the trigger condition is met, the ring keeps filling until
+  * SCOPE_DEPTH - pretrigger samples follow the trigger and is then frozen,
+  * so the capture holds N pre-trigger and M post-trigger samples.
+  ******************************************************************************
+  */
+
+#ifndef __SCOPE_CAPTURE_H
+#define __SCOPE_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define SCOPE_DEPTH             128   // Samples per capture (one per column at 1x)
+#define SCOPE_SAMPLE_RATE_HZ    1000  // Sampling rate of the capture timer
+#define SCOPE_ADC_FULL_SCALE    4095  // 12-bit raw samples
+
+typedef enum {
+    SCOPE_SOURCE_VOLTAGE = 0,
+    SCOPE_SOURCE_CURRENT
+} Scope_Source_t;
+
+typedef enum {
+    SCOPE_EDGE_RISING = 0,
+    SCOPE_EDGE_FALLING
+} Scope_Edge_t;
+
+typedef enum {
+    SCOPE_STOPPED = 0,    // Not sampling
+    SCOPE_ARMED,          // Filling the ring, waiting for the trigger
+    SCOPE_TRIGGERED,      // Trigger seen, filling the post-trigger samples
+    SCOPE_DONE            // Capture frozen
+} Scope_State_t;
+
+typedef struct {
+    uint16_t voltage;     // Raw ADC value of the voltage channel
+    uint16_t current;     // Raw ADC value of the current channel
+} Scope_Sample_t;
+
+typedef struct {
+    Scope_Source_t source;
+    Scope_Edge_t edge;
+    uint16_t level;       // Trigger level in raw ADC units
+    uint16_t pretrigger;  // Samples kept before the trigger (N < SCOPE_DEPTH)
+} Scope_Config_t;
+
+void Scope_Set_Config(const Scope_Config_t* config);
+const Scope_Config_t* Scope_Get_Config(void);
+void Scope_Arm(void);
+void Scope_Stop(void);
+void Scope_Add_Sample(uint16_t voltage, uint16_t current);
+Scope_State_t Scope_Get_State(void);
+const Scope_Sample_t* Scope_Get_Sample(uint16_t index);
+uint16_t Scope_Get_Value(const Scope_Sample_t* sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCOPE_CAPTURE_H */
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : screens.h
+  * @brief          : Screens of the power meter and their views
+  ******************************************************************************
+  * The menu table of every screen, the views it draws and their state. The
+  * measurements, the button and the display bus profile are read from
+  * main.c, which runs the measurement tick and the inputs; nothing here
+  * touches the hardware, so the host build links the same screens with
+  * fixed inputs and renders them.
+  ******************************************************************************
+  */
+
+#ifndef __SCREENS_H
+#define __SCREENS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "i2c_timing.h"
+
+typedef enum {
+    MENU_POWER_METER = 0,    // Main power meter display
+    MENU_MAIN,               // Main menu
+    MENU_PEAKS,              // Peak values display
+    MENU_GRAPHICS,           // Graphics display menu
+    MENU_GRAPHICS_SELECT,    // Graphics parameter selection
+    MENU_SETTINGS,           // Settings menu
+    MENU_RESET,              // Reset menu
+    MENU_ABOUT,              // About/Info
+    MENU_HISTOGRAM,          // Power distribution histogram
+    MENU_SCOPE,              // Triggered waveform capture
+    MENU_SCOPE_SETTINGS,     // Scope trigger configuration
+    MENU_DIAGNOSTICS         // Frame rates, dropped frames and display bus health
+} MenuState_t;
+#define MENU_COUNT (MENU_DIAGNOSTICS + 1)  // Number of screens
+
+typedef struct {
+    uint32_t count;         // Recoveries run
+    uint32_t failures;      // Recoveries after which the display still failed
+    uint32_t last_tick;     // Start of the last recovery
+    uint32_t last_ms;       // Duration of the last recovery
+    uint32_t max_ms;        // Longest recovery
+    uint32_t total_ms;      // Time spent recovering
+} Display_Recovery_Log_t;
+
+// Measurements and inputs shown by the screens, written by the timer handler of main.c
+extern float simulated_voltage;     // Simulated voltage (V)
+extern float simulated_current;     // Simulated current (A)
+extern float simulated_power;       // Calculated power (W)
+extern float accumulated_energy;    // Accumulated energy (Wh)
+extern float peak_voltage;
+extern float peak_current;
+extern float peak_power;
+extern uint8_t rotary_counter;
+extern uint8_t button_state;
+
+// Display bus speed chosen in the settings, applied by the timer handler between frames
+extern I2C_Profile_t i2c_requested_profile;
+extern Display_Recovery_Log_t display_recovery_log;
+
+uint8_t Button_Held_For_Turn(void);
+
+void Screens_Init(void);
+void Screens_Invalidate(void);
+void Screens_Record_Flush(uint16_t bytes);
+// The views themselves are declared in main.h
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCREENS_H */
@@ -53,7 +53,10 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void EXTI0_1_IRQHandler(void);
 void EXTI4_15_IRQHandler(void);
+void DMA1_Channel2_3_IRQHandler(void);
 void TIM6_DAC_IRQHandler(void);
+void TIM21_IRQHandler(void);
+void I2C1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : text_field.h
+  * @brief          : Retained labelled value fields for the text screens
+  ******************************************************************************
+  * A screen is a const table of fields, each with a position, font, label and
+  * fixed-point value layout, plus a small RAM array holding the characters
+  * currently in the screenbuffer. Setting a value only draws the character cells that
+  * differ from what is shown, so the dirty window of a frame covers the
+  * digits that changed instead of the whole screen.
+  ******************************************************************************
+  */
+
+#ifndef __TEXT_FIELD_H
+#define __TEXT_FIELD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "../Src/ssd1306/ssd1306_fonts.h"
+
+#define TEXT_FIELD_MAX_CHARS    8     // Value cells of the widest field
+
+typedef struct {
+    uint8_t x;                  // Left edge of the label
+    uint8_t y;
+    const FontDef* font;
+    const char* label;          // Drawn once before the value, NULL for none
+    const char* unit;           // Drawn after a value of Text_Field_Set_Value, NULL for none
+    uint8_t decimals;           // Digits after the point of Text_Field_Set_Value
+    uint8_t flags;              // FORMAT_ flags of Text_Field_Set_Value
+    uint8_t width;              // Value cells with the unit, at most TEXT_FIELD_MAX_CHARS
+} Text_Field_Def_t;
+
+typedef struct {
+    const Text_Field_Def_t* fields;
+    char (*shown)[TEXT_FIELD_MAX_CHARS];    // Cells in the screenbuffer, one row per field
+    uint8_t count;
+} Text_Screen_t;
+
+void Text_Screen_Invalidate(const Text_Screen_t* screen);
+void Text_Field_Set(const Text_Screen_t* screen, uint32_t field, const char* text);
+void Text_Field_Set_Value(const Text_Screen_t* screen, uint8_t field, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEXT_FIELD_H */
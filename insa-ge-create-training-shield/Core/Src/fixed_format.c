@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file           : fixed_format.c
+  * @brief          : Fixed-point number formatting for the display paths
+  ******************************************************************************
+  */
+
+#include "fixed_format.h"
+
+#define FORMAT_MAX_DIGITS   10      // Digits of the largest 32-bit magnitude
+
+static const uint32_t format_pow10[FORMAT_MAX_DIGITS] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+static void Format_Put(Format_Buffer_t* out, char c, uint8_t count)
+{
+    while (count-- > 0 && out->length + 1 < out->size) {
+        out->text[out->length++] = c;
+    }
+    out->text[out->length] = '\0';
+}
+
+/**
+  * @brief  Start an empty string in a caller buffer
+  * @param  out Formatting state
+  * @param  text Buffer receiving the string
+  * @param  size Size of text, at least 1
+  */
+void Format_Begin(Format_Buffer_t* out, char* text, uint8_t size)
+{
+    out->text = text;
+    out->size = size;
+    out->length = 0;
+    text[0] = '\0';
+}
+
+/**
+  * @brief  Append one character
+  */
+void Format_Char(Format_Buffer_t* out, char c)
+{
+    Format_Put(out, c, 1);
+}
+
+/**
+  * @brief  Append a string
+  */
+void Format_Text(Format_Buffer_t* out, const char* text)
+{
+    while (*text != '\0' && out->length + 1 < out->size) {
+        out->text[out->length++] = *text++;
+    }
+    out->text[out->length] = '\0';
+}
+
+/**
+  * @brief  Append blanks up to a column, for left-aligned table cells
+  * @param  column Length of the string afterwards, nothing if already reached
+  */
+void Format_Pad(Format_Buffer_t* out, uint8_t column)
+{
+    if (column > out->length) {
+        Format_Put(out, ' ', column - out->length);
+    }
+}
+
+/**
+  * @brief  Append a fixed-point value
+  * @param  value Value in units of 10^-scale
+  * @param  scale Decimal digits of value after the point, at most FORMAT_MAX_DECIMALS
+  * @param  decimals Digits printed after the point, at most FORMAT_MAX_DECIMALS.
+  *         Fewer than scale rounds half away from zero, more appends zeros
+  * @param  width Minimum length, sign and point included
+  * @param  flags FORMAT_ZERO_PAD, FORMAT_LEFT, FORMAT_PLUS
+  * @note   Unlike printf, a negative value that rounds to zero prints without
+  *         a minus sign, so a reading hovering around zero does not flicker
+  */
+void Format_Fixed(Format_Buffer_t* out, int32_t value, uint8_t scale, uint8_t decimals,
+                  uint8_t width, uint8_t flags)
+{
+    char digits[FORMAT_MAX_DIGITS];
+    uint32_t magnitude = (value < 0) ? 0UL - (uint32_t)value : (uint32_t)value;
+    uint8_t count = 0;
+    uint8_t length;
+    uint8_t dropped = 0;
+    char sign = '\0';
+    int8_t power;
+
+    if (scale > FORMAT_MAX_DECIMALS) scale = FORMAT_MAX_DECIMALS;
+    if (decimals > FORMAT_MAX_DECIMALS) decimals = FORMAT_MAX_DECIMALS;
+
+    // Round away the digits that are not shown: add half a unit of the last
+    // shown digit, then stop the digit loop before the dropped ones. The sum
+    // stays below 2^32 as the magnitude is at most 2^31
+    if (decimals < scale) {
+        dropped = scale - decimals;
+        magnitude += format_pow10[dropped] >> 1;
+        scale = decimals;
+    }
+
+    // Digits without leading zeros, but always one before the point
+    for (power = FORMAT_MAX_DIGITS - 1; power >= dropped; power--) {
+        char digit = '0';
+
+        while (magnitude >= format_pow10[power]) {
+            magnitude -= format_pow10[power];
+            digit++;
+        }
+        if (digit != '0' || count > 0 || power - dropped <= scale) {
+            digits[count++] = digit;
+        }
+    }
+
+    if (value < 0) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (digits[i] != '0') {
+                sign = '-';
+                break;
+            }
+        }
+    }
+    if (sign == '\0' && (flags & FORMAT_PLUS)) {
+        sign = '+';
+    }
+
+    length = count + (decimals - scale) + (decimals > 0) + (sign != '\0');
+
+    if (!(flags & (FORMAT_LEFT | FORMAT_ZERO_PAD)) && width > length) {
+        Format_Put(out, ' ', width - length);
+    }
+    if (sign != '\0') {
+        Format_Put(out, sign, 1);
+    }
+    if ((flags & FORMAT_ZERO_PAD) && !(flags & FORMAT_LEFT) && width > length) {
+        Format_Put(out, '0', width - length);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (decimals > 0 && i == count - scale) {
+            Format_Put(out, '.', 1);
+        }
+        Format_Put(out, digits[i], 1);
+    }
+    if (decimals > 0 && scale == 0) {
+        Format_Put(out, '.', 1);
+    }
+    Format_Put(out, '0', decimals - scale);
+    if ((flags & FORMAT_LEFT) && width > length) {
+        Format_Put(out, ' ', width - length);
+    }
+}
+
+/**
+  * @brief  Append an integer, Format_Fixed without a fraction
+  */
+void Format_Int(Format_Buffer_t* out, int32_t value, uint8_t width, uint8_t flags)
+{
+    Format_Fixed(out, value, 0, 0, width, flags);
+}
+
+/**
+  * @brief  Convert a measurement to fixed point
+  * @param  value Value to convert
+  * @param  decimals Digits kept after the point, at most FORMAT_MAX_DECIMALS
+  * @retval value * 10^decimals rounded half away from zero, saturated to 32 bits
+  */
+int32_t Format_From_Float(float value, uint8_t decimals)
+{
+    float scaled;
+
+    if (decimals > FORMAT_MAX_DECIMALS) decimals = FORMAT_MAX_DECIMALS;
+    scaled = value * (float)format_pow10[decimals];
+
+    if (scaled >= 2147483520.0f) return INT32_MAX;      // Largest float below 2^31
+    if (scaled <= -2147483520.0f) return -INT32_MAX;
+    return (int32_t)(scaled + ((scaled < 0.0f) ? -0.5f : 0.5f));
+}
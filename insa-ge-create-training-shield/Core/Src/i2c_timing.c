@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file           : i2c_timing.c
+  * @brief          : I2C bus speed profiles for the display bus
+  ******************************************************************************
+  */
+
+#include "i2c_timing.h"
+
+#define I2C_ANALOG_FILTER_MIN_NS    50    // Analog filter delay, minimum
+#define I2C_ANALOG_FILTER_MAX_NS    260   // Analog filter delay, maximum
+#define I2C_PRESC_MAX               15
+#define I2C_SCLDEL_MAX              15
+#define I2C_SDADEL_MAX              15
+#define I2C_SCLX_MAX                255
+
+// I2C specification limits of one bus mode, in nanoseconds
+typedef struct {
+    uint32_t bus_hz;
+    uint16_t low_min;       // tLOW
+    uint16_t high_min;      // tHIGH
+    uint16_t setup_min;     // tSU;DAT
+    uint16_t hold_max;      // tVD;DAT
+    const char* name;
+} I2C_Timing_Spec_t;
+
+static const I2C_Timing_Spec_t i2c_timing_specs[I2C_PROFILE_COUNT] = {
+    { 100000, 4700, 4000, 250, 3450, "100k" },
+    { 400000, 1300,  600, 100,  900, "400k" },
+    { 1000000, 500,  260,  50,  450, "1M" }
+};
+
+static I2C_Profile_t i2c_current_profile = I2C_PROFILE_DEFAULT;
+
+/**
+  * @brief  Number of prescaled clock periods covering a duration, rounded up
+  */
+static uint32_t I2C_Timing_Cycles(uint32_t duration_ps, uint32_t period_ps)
+{
+    return (duration_ps + period_ps - 1) / period_ps;
+}
+
+/**
+  * @brief  Compute the TIMINGR value of a profile
+  * @param  kernel_clock_hz Clock feeding the I2C peripheral
+  * @param  profile Bus speed profile
+  * @retval TIMINGR value, 0 if the clock is too slow or too fast for the mode
+  * @note   SCL stays at or below the nominal bus frequency: when the minimum
+  *         low and high times do not fit in the period, the bus runs slower
+  */
+uint32_t I2C_Timing_Compute(uint32_t kernel_clock_hz, I2C_Profile_t profile)
+{
+    const I2C_Timing_Spec_t* spec;
+    uint32_t clock_ps, scl_period_ps, sync_ps, budget_ps;
+    uint32_t low_ps, high_ps;
+
+    if (profile >= I2C_PROFILE_COUNT || kernel_clock_hz < 1000) return 0;
+    spec = &i2c_timing_specs[profile];
+
+    // Picoseconds keep the arithmetic exact at 32 MHz (31.25 ns per clock)
+    clock_ps = 1000000000UL / (kernel_clock_hz / 1000);
+    scl_period_ps = 1000000000UL / (spec->bus_hz / 1000);
+
+    // Each SCL edge is seen through the analog filter and 2 synchronisation clocks
+    sync_ps = 2 * (I2C_ANALOG_FILTER_MIN_NS * 1000 + 2 * clock_ps);
+    budget_ps = scl_period_ps - (I2C_TIMING_RISE_NS + I2C_TIMING_FALL_NS) * 1000;
+    budget_ps = (budget_ps > sync_ps) ? budget_ps - sync_ps : 0;
+
+    // Split the period in the ratio of the minimum low and high times
+    low_ps = budget_ps / (spec->low_min + spec->high_min) * spec->low_min;
+    if (low_ps < spec->low_min * 1000UL) low_ps = spec->low_min * 1000UL;
+    high_ps = (budget_ps > low_ps) ? budget_ps - low_ps : 0;
+    if (high_ps < spec->high_min * 1000UL) high_ps = spec->high_min * 1000UL;
+
+    // The smallest prescaler gives the finest resolution
+    for (uint32_t presc = 0; presc <= I2C_PRESC_MAX; presc++) {
+        uint32_t presc_ps = (presc + 1) * clock_ps;
+        uint32_t scll = I2C_Timing_Cycles(low_ps, presc_ps) - 1;
+        uint32_t sclh = I2C_Timing_Cycles(high_ps, presc_ps) - 1;
+        uint32_t scldel = I2C_Timing_Cycles((I2C_TIMING_RISE_NS + spec->setup_min) * 1000UL, presc_ps) - 1;
+        int32_t sdadel_min_ps = (int32_t)(I2C_TIMING_FALL_NS - I2C_ANALOG_FILTER_MIN_NS) * 1000 -
+                                3 * (int32_t)clock_ps;
+        int32_t sdadel_max_ps = (int32_t)(spec->hold_max - I2C_TIMING_RISE_NS - I2C_ANALOG_FILTER_MAX_NS) * 1000 -
+                                4 * (int32_t)clock_ps;
+        uint32_t sdadel = (sdadel_min_ps > 0) ? I2C_Timing_Cycles((uint32_t)sdadel_min_ps, presc_ps) : 0;
+
+        if (scll > I2C_SCLX_MAX || sclh > I2C_SCLX_MAX) continue;
+        if (scldel > I2C_SCLDEL_MAX || sdadel > I2C_SDADEL_MAX) continue;
+        // The hold limit can only be checked against a delay we add ourselves
+        if (sdadel > 0 && (int32_t)(sdadel * presc_ps) > sdadel_max_ps) return 0;
+
+        return (presc << I2C_TIMINGR_PRESC_Pos) |
+               (scldel << I2C_TIMINGR_SCLDEL_Pos) |
+               (sdadel << I2C_TIMINGR_SDADEL_Pos) |
+               (sclh << I2C_TIMINGR_SCLH_Pos) |
+               (scll << I2C_TIMINGR_SCLL_Pos);
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  Switch the bus to a speed profile
+  * @param  hi2c I2C handle, must be idle
+  * @param  profile Bus speed profile
+  * @retval HAL_ERROR if the kernel clock cannot produce the profile
+  */
+HAL_StatusTypeDef I2C_Timing_Apply(I2C_HandleTypeDef* hi2c, I2C_Profile_t profile)
+{
+    uint32_t timing = I2C_Timing_Compute(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C1), profile);
+
+    if (timing == 0) return HAL_ERROR;
+    if (hi2c->State != HAL_I2C_STATE_READY) return HAL_BUSY;
+
+    // Fast-mode Plus needs the 20 mA drive of the PB8/PB9 pads
+    if (profile == I2C_PROFILE_FAST_PLUS) {
+        HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_PB8);
+        HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_PB9);
+    } else {
+        HAL_I2CEx_DisableFastModePlus(I2C_FASTMODEPLUS_PB8);
+        HAL_I2CEx_DisableFastModePlus(I2C_FASTMODEPLUS_PB9);
+    }
+
+    // TIMINGR can only be written while the peripheral is disabled
+    __HAL_I2C_DISABLE(hi2c);
+    hi2c->Instance->TIMINGR = timing;
+    hi2c->Init.Timing = timing;
+    __HAL_I2C_ENABLE(hi2c);
+
+    i2c_current_profile = profile;
+    return HAL_OK;
+}
+
+/**
+  * @brief  Profile applied by the last successful I2C_Timing_Apply
+  */
+I2C_Profile_t I2C_Timing_Get_Profile(void)
+{
+    return i2c_current_profile;
+}
+
+/**
+  * @brief  Short profile name for the menus
+  */
+const char* I2C_Timing_Get_Name(I2C_Profile_t profile)
+{
+    if (profile >= I2C_PROFILE_COUNT) return "?";
+    return i2c_timing_specs[profile].name;
+}
+
+/**
+  * @brief  Nominal SCL frequency of a profile
+  */
+uint32_t I2C_Timing_Get_Bus_Hz(I2C_Profile_t profile)
+{
+    if (profile >= I2C_PROFILE_COUNT) return 0;
+    return i2c_timing_specs[profile].bus_hz;
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file           : input_queue.c
+  * @brief          : Lock-free input event queues from the interrupts
+  ******************************************************************************
+  */
+
+#include "input_queue.h"
+#include <stddef.h>
+#include "main.h"
+
+#define INPUT_QUEUE_MASK (INPUT_QUEUE_SIZE - 1)
+
+/**
+  * @brief  Add an event, from the interrupt owning the queue
+  * @param  queue Queue of the calling interrupt
+  * @param  source Input that fired
+  * @param  value Pin levels read by the interrupt
+  * @param  now Current tick in milliseconds
+  * @retval 1 when queued, 0 when the queue is full and the event is dropped
+  */
+uint8_t Input_Push(Input_Queue_t* queue, uint8_t source, uint8_t value, uint32_t now)
+{
+    uint8_t head = queue->head;
+    Input_Event_t* event;
+
+    if ((uint8_t)(head - queue->tail) >= INPUT_QUEUE_SIZE) {
+        queue->dropped++;
+        return 0;
+    }
+    event = &queue->events[head & INPUT_QUEUE_MASK];
+    event->time = (uint16_t)now;
+    event->source = source;
+    event->value = value;
+
+    // The event must be complete before the consumer can see it
+    __DMB();
+    queue->head = head + 1;
+    return 1;
+}
+
+/**
+  * @brief  Oldest event of a queue, left in place
+  * @retval The event, or NULL when the queue is empty
+  */
+const Input_Event_t* Input_Peek(const Input_Queue_t* queue)
+{
+    uint8_t tail = queue->tail;
+
+    if (tail == queue->head) return NULL;
+    __DMB();
+    return &queue->events[tail & INPUT_QUEUE_MASK];
+}
+
+/**
+  * @brief  Release the event returned by Input_Peek, from the consumer
+  */
+void Input_Pop(Input_Queue_t* queue)
+{
+    uint8_t tail = queue->tail;
+
+    if (tail == queue->head) return;
+    // The event is read before the producer may overwrite its slot
+    __DMB();
+    queue->tail = tail + 1;
+}
+
+/**
+  * @brief  Full tick of an event
+  * @param  event Event queued less than 32 s ago
+  * @param  now Current tick in milliseconds
+  * @note   The difference is signed: an event queued after now was read,
+  *         by an interrupt preempting the consumer, is not 65 s old
+  */
+uint32_t Input_Event_Time(const Input_Event_t* event, uint32_t now)
+{
+    return now - (int16_t)((uint16_t)now - event->time);
+}
@@ -21,8 +21,16 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-#include <stdio.h>
+#include <string.h>
 #include "ssd1306/ssd1306.h"
+#include "power_history.h"
+#include "power_histogram.h"
+#include "scope_capture.h"
+#include "i2c_timing.h"
+#include "render_scheduler.h"
+#include "menu.h"
+#include "input_queue.h"
+#include "screens.h"
 
 /* USER CODE END Includes */
 
@@ -45,71 +53,85 @@
 ADC_HandleTypeDef hadc;
 
 I2C_HandleTypeDef hi2c1;
+DMA_HandleTypeDef hdma_i2c1_tx;
 
 TIM_HandleTypeDef htim6;
+TIM_HandleTypeDef htim21;
 
 /* USER CODE BEGIN PV */
+#if ROTARY_HW_ENCODER
+TIM_HandleTypeDef htim2;
+static uint16_t rotary_last_count;  // TIM2 count at the last tick
+#endif
 static uint8_t rotary_state;
-static uint8_t rotary_counter;
-static uint8_t button_state;
+uint8_t rotary_counter;
+uint8_t button_state;
 
 // Power meter simulation variables
-static float simulated_voltage = 0.0f;    // Simulated voltage (V)
-static float simulated_current = 0.0f;    // Simulated current (A)
-static float simulated_power = 0.0f;      // Calculated power (W)
-static float accumulated_energy = 0.0f;   // Accumulated energy (Wh)
+float simulated_voltage = 0.0f;           // Simulated voltage (V)
+float simulated_current = 0.0f;           // Simulated current (A)
+float simulated_power = 0.0f;             // Calculated power (W)
+float accumulated_energy = 0.0f;          // Accumulated energy (Wh)
 static uint32_t last_timestamp = 0;       // For energy integration
 
 // Peak value tracking
-static float peak_voltage = 0.0f;
-static float peak_current = 0.0f;
-static float peak_power = 0.0f;
+float peak_voltage = 0.0f;
+float peak_current = 0.0f;
+float peak_power = 0.0f;
 
 // Button handling for reset functions
 static uint32_t button_press_time = 0;
 static uint8_t button_long_press_handled = 0;
-static uint32_t button_last_interrupt_time = 0;  // For debouncing
-static uint8_t button_stable_state = 0;          // Stable button state after debouncing
+static uint8_t button_pending = 0;               // A new level waits to stay stable
+static uint8_t button_pending_level;
+static uint32_t button_pending_time;
 
 // Menu system variables
-typedef enum {
-    MENU_POWER_METER = 0,    // Main power meter display
-    MENU_MAIN,               // Main menu
-    MENU_PEAKS,              // Peak values display
-    MENU_GRAPHICS,           // Graphics display menu
-    MENU_GRAPHICS_SELECT,    // Graphics parameter selection
-    MENU_SETTINGS,           // Settings menu
-    MENU_RESET,              // Reset menu
-    MENU_ABOUT               // About/Info
-} MenuState_t;
-
-static MenuState_t current_menu = MENU_POWER_METER;
-static uint8_t menu_selection = 0;      // Current menu item selection
 static uint8_t menu_changed = 1;        // Flag to trigger display update
 static uint32_t last_activity_time = 0; // For auto-return to power meter
 
 // Rotary encoder debouncing variables
-static uint32_t rotary_last_interrupt_time = 0;
-
-// Graphics functionality variables
-#define GRAPH_DATA_POINTS 64  // Number of data points for graph (64 points across 128 pixel width)
-static float voltage_history[GRAPH_DATA_POINTS];
-static float current_history[GRAPH_DATA_POINTS];
-static float power_history[GRAPH_DATA_POINTS];
-static uint8_t graph_data_index = 0;
-static uint8_t graphics_parameter = 0;  // 0 = Voltage, 1 = Current, 2 = Power
+static uint32_t rotary_last_event_time = 0;
+
+// Input events: the interrupts only queue their pin levels, the measurement
+// tick runs the debouncing and the menu logic, alone writing the menu state
+#define INPUT_ROTARY        0   // Value: ROT_CHA << 1 | ROT_CHB
+#define INPUT_BUTTON        1   // Value: USER_BUTTON level
+#define ROTARY_DEBOUNCE_MS  5   // Edges closer than this are bounces
+#define BUTTON_DEBOUNCE_MS  20  // A button level is accepted once it held this long
+static Input_Queue_t rotary_queue;
+static Input_Queue_t button_queue;
+
+// Graphics history and scope sampler
 static uint32_t last_graph_update = 0;
+static uint8_t scope_sampler_running = 0;
+
+// Display bus speed, applied by the timer handler between frames
+I2C_Profile_t i2c_requested_profile = I2C_PROFILE_DEFAULT;
+
+// Display bus recovery, run by the main loop while the timer keeps measuring
+#define DISPLAY_I2C_GPIO_Port GPIOB
+#define DISPLAY_SCL_Pin       GPIO_PIN_8
+#define DISPLAY_SDA_Pin       GPIO_PIN_9
+#define DISPLAY_RETRY_MS      1000  // Delay between failed recoveries
+static volatile uint8_t display_degraded = 0;  // Display left out of the refresh
+Display_Recovery_Log_t display_recovery_log;
 
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_ADC_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_TIM6_Init(void);
+static void MX_TIM21_Init(void);
 /* USER CODE BEGIN PFP */
-
+static void Display_Recover(void);
+#if ROTARY_HW_ENCODER
+static void Rotary_Encoder_Timer_Init(void);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -202,324 +224,35 @@ void Handle_Menu_Navigation(int8_t direction)
     last_activity_time = HAL_GetTick();
     menu_changed = 1;
     
-    switch (current_menu) {
-        case MENU_MAIN:
-            // Navigate main menu items
-            if (direction > 0) {
-                menu_selection = (menu_selection + 1) % 5; // 5 main menu items
-            } else {
-                menu_selection = (menu_selection == 0) ? 4 : menu_selection - 1;
-            }
-            break;
-            
-        case MENU_GRAPHICS_SELECT:
-            // Navigate graphics parameter selection
-            if (direction > 0) {
-                menu_selection = (menu_selection + 1) % 4; // 4 graphics items (V, A, P, Back)
-            } else {
-                menu_selection = (menu_selection == 0) ? 3 : menu_selection - 1;
-            }
-            break;
-            
-        case MENU_SETTINGS:
-            // Navigate settings menu items  
-            if (direction > 0) {
-                menu_selection = (menu_selection + 1) % 2; // 2 settings items
-            } else {
-                menu_selection = (menu_selection == 0) ? 1 : menu_selection - 1;
-            }
-            break;
-            
-        case MENU_RESET:
-            // Navigate reset menu items
-            if (direction > 0) {
-                menu_selection = (menu_selection + 1) % 3; // 3 reset items
-            } else {
-                menu_selection = (menu_selection == 0) ? 2 : menu_selection - 1;
-            }
-            break;
-            
-        default:
-            // Other menus don't have navigation
-            break;
-    }
+    Menu_Turn(direction);
 }
 
 /**
   * @brief  Handle button press for menu actions
-  * @param  press_type: 0 = short press, 1 = long press
+  * @param  press_type: 0 = short press (enter/confirm), 1 = long press (home)
   */
 void Handle_Menu_Action(uint8_t press_type)
 {
     last_activity_time = HAL_GetTick();
     menu_changed = 1;
     
-    if (press_type == 1) { // Long press - always go back/up
-        switch (current_menu) {
-            case MENU_POWER_METER:
-                current_menu = MENU_MAIN;
-                menu_selection = 0;
-                break;
-                
-            default:
-                current_menu = MENU_POWER_METER;
-                menu_selection = 0;
-                break;
-        }
-    } else { // Short press - enter/confirm
-        switch (current_menu) {
-            case MENU_POWER_METER:
-                // No action on short press in power meter mode
-                break;
-                
-            case MENU_MAIN:
-                switch (menu_selection) {
-                    case 0: current_menu = MENU_POWER_METER; break;  // Back to Power Meter
-                    case 1: current_menu = MENU_PEAKS; break;        // Peak Values
-                    case 2: current_menu = MENU_GRAPHICS_SELECT; menu_selection = 0; break; // Graphics
-                    case 3: current_menu = MENU_SETTINGS; menu_selection = 0; break; // Settings
-                    case 4: current_menu = MENU_RESET; menu_selection = 0; break;    // Reset
-                }
-                break;
-                
-            case MENU_PEAKS:
-                current_menu = MENU_MAIN;
-                menu_selection = 1;
-                break;
-                
-            case MENU_GRAPHICS_SELECT:
-                switch (menu_selection) {
-                    case 0: // Voltage graph
-                        graphics_parameter = 0;
-                        current_menu = MENU_GRAPHICS;
-                        break;
-                    case 1: // Current graph
-                        graphics_parameter = 1;
-                        current_menu = MENU_GRAPHICS;
-                        break;
-                    case 2: // Power graph
-                        graphics_parameter = 2;
-                        current_menu = MENU_GRAPHICS;
-                        break;
-                    case 3: // Back
-                        current_menu = MENU_MAIN;
-                        menu_selection = 2;
-                        break;
-                }
-                break;
-                
-            case MENU_GRAPHICS:
-                current_menu = MENU_GRAPHICS_SELECT;
-                menu_selection = graphics_parameter;
-                break;
-                
-            case MENU_SETTINGS:
-                switch (menu_selection) {
-                    case 0: current_menu = MENU_ABOUT; break;      // About
-                    case 1: current_menu = MENU_MAIN; menu_selection = 2; break; // Back
-                }
-                break;
-                
-            case MENU_RESET:
-                switch (menu_selection) {
-                    case 0: Reset_Peaks(); current_menu = MENU_MAIN; menu_selection = 3; break;   // Reset Peaks
-                    case 1: Reset_Energy(); current_menu = MENU_MAIN; menu_selection = 3; break;  // Reset Energy
-                    case 2: current_menu = MENU_MAIN; menu_selection = 3; break;                  // Cancel
-                }
-                break;
-                
-            case MENU_ABOUT:
-                current_menu = MENU_SETTINGS;
-                menu_selection = 0;
-                break;
-        }
+    if (press_type == 1) {
+        Menu_Long_Press();
+    } else {
+        Menu_Press();
     }
 }
 
 /**
-  * @brief  Display current menu on OLED
+  * @brief  Tell whether the button is held while the encoder turns
+  * @retval 1 when held; the release then no longer counts as a short press
   */
-void Display_Current_Menu(void)
+uint8_t Button_Held_For_Turn(void)
 {
-    char line1[21] = {0};
-    char line2[21] = {0};
-    char line3[21] = {0};
-    
-    // Clear screen
-    ssd1306_Fill(Black);
-    
-    switch (current_menu) {
-        case MENU_POWER_METER:
-            Display_Power_Meter();
-            return; // Power meter has its own display logic
-            
-        case MENU_MAIN:
-            {
-                // Main menu items (total 5 items: 0-4)
-                const char* menu_items[5] = {
-                    " Power Meter",
-                    " Peak Values",
-                    " Graphics", 
-                    " Settings",
-                    " Reset Options"
-                };
-                
-                ssd1306_SetCursor(0, 0);
-                ssd1306_WriteString("=== MAIN MENU ===", Font_6x8, White);
-                
-                // Calculate scroll window (show 3 items at a time)
-                uint8_t start_item = 0;
-                if (menu_selection >= 2) {
-                    start_item = menu_selection - 1;  // Keep selected item in middle when possible
-                    if (start_item > 2) start_item = 2;  // Don't scroll beyond last window (5-3=2)
-                }
-                
-                // Display 3 visible items
-                for (uint8_t i = 0; i < 3 && (start_item + i) < 5; i++) {
-                    uint8_t item_index = start_item + i;
-                    char display_line[21];
-                    
-                    // Add selection marker
-                    sprintf(display_line, "%s%s", 
-                           (item_index == menu_selection) ? ">" : " ",
-                           menu_items[item_index]);
-                    
-                    ssd1306_SetCursor(0, 8 + (i * 8));  // Y positions: 8, 16, 24
-                    ssd1306_WriteString(display_line, Font_6x8, White);
-                }
-                
-                // Optional: Add scroll indicators
-                if (start_item > 0) {
-                    // Show "up arrow" indicator at top-right
-                    ssd1306_SetCursor(120, 8);
-                    ssd1306_WriteString("^", Font_6x8, White);
-                }
-                if (start_item + 3 < 5) {
-                    // Show "down arrow" indicator at bottom-right  
-                    ssd1306_SetCursor(120, 24);
-                    ssd1306_WriteString("v", Font_6x8, White);
-                }
-            }
-            break;
-            
-        case MENU_PEAKS:
-            ssd1306_SetCursor(0, 0);
-            ssd1306_WriteString("=== PEAK VALUES ===", Font_6x8, White);
-            
-            // Display peak values using integer formatting
-            int pv_int = (int)peak_voltage;
-            int pv_frac = (int)((peak_voltage - pv_int) * 10.0f);
-            int pi_int = (int)peak_current;
-            int pi_frac = (int)((peak_current - pi_int) * 100.0f);
-            int pp_int = (int)peak_power;
-            int pp_frac = (int)((peak_power - pp_int) * 10.0f);
-            
-            sprintf(line1, "V: %d.%dV", pv_int, pv_frac);
-            sprintf(line2, "I: %d.%02dA", pi_int, pi_frac);
-            sprintf(line3, "P: %d.%dW", pp_int, pp_frac);
-            
-            ssd1306_SetCursor(0, 10);
-            ssd1306_WriteString(line1, Font_7x10, White);
-            ssd1306_SetCursor(0, 20);
-            ssd1306_WriteString(line2, Font_7x10, White);
-            ssd1306_SetCursor(70, 20);
-            ssd1306_WriteString(line3, Font_7x10, White);
-            break;
-            
-        case MENU_SETTINGS:
-            ssd1306_SetCursor(0, 0);
-            ssd1306_WriteString("=== SETTINGS ===", Font_6x8, White);
-            
-            sprintf(line1, "%s About", (menu_selection == 0) ? ">" : " ");
-            sprintf(line2, "%s Back", (menu_selection == 1) ? ">" : " ");
-            
-            ssd1306_SetCursor(0, 12);
-            ssd1306_WriteString(line1, Font_7x10, White);
-            ssd1306_SetCursor(0, 22);
-            ssd1306_WriteString(line2, Font_7x10, White);
-            break;
-            
-        case MENU_RESET:
-            ssd1306_SetCursor(0, 0);
-            ssd1306_WriteString("=== RESET ===", Font_6x8, White);
-            
-            sprintf(line1, "%s Reset Peaks", (menu_selection == 0) ? ">" : " ");
-            sprintf(line2, "%s Reset Energy", (menu_selection == 1) ? ">" : " ");
-            sprintf(line3, "%s Cancel", (menu_selection == 2) ? ">" : " ");
-            
-            ssd1306_SetCursor(0, 8);
-            ssd1306_WriteString(line1, Font_6x8, White);
-            ssd1306_SetCursor(0, 16);
-            ssd1306_WriteString(line2, Font_6x8, White);
-            ssd1306_SetCursor(0, 24);
-            ssd1306_WriteString(line3, Font_6x8, White);
-            break;
-            
-        case MENU_GRAPHICS_SELECT:
-            {
-                // Graphics menu items (total 4 items: 0-3)
-                const char* graphics_items[4] = {
-                    " Voltage (V)",
-                    " Current (A)",
-                    " Power (W)",
-                    " Back"
-                };
-                
-                ssd1306_SetCursor(0, 0);
-                ssd1306_WriteString("=== GRAPHICS ===", Font_6x8, White);
-                
-                // Calculate scroll window (show 3 items at a time)
-                uint8_t start_item = 0;
-                if (menu_selection >= 2) {
-                    start_item = menu_selection - 1;  // Keep selected item in middle when possible
-                    if (start_item > 1) start_item = 1;  // Don't scroll beyond last window (4-3=1)
-                }
-                
-                // Display 3 visible items
-                for (uint8_t i = 0; i < 3 && (start_item + i) < 4; i++) {
-                    uint8_t item_index = start_item + i;
-                    char display_line[21];
-                    
-                    // Add selection marker
-                    sprintf(display_line, "%s%s", 
-                           (item_index == menu_selection) ? ">" : " ",
-                           graphics_items[item_index]);
-                    
-                    ssd1306_SetCursor(0, 8 + (i * 8));  // Y positions: 8, 16, 24
-                    ssd1306_WriteString(display_line, Font_6x8, White);
-                }
-                
-                // Optional: Add scroll indicators
-                if (start_item > 0) {
-                    // Show "up arrow" indicator at top-right
-                    ssd1306_SetCursor(120, 8);
-                    ssd1306_WriteString("^", Font_6x8, White);
-                }
-                if (start_item + 3 < 4) {
-                    // Show "down arrow" indicator at bottom-right  
-                    ssd1306_SetCursor(120, 24);
-                    ssd1306_WriteString("v", Font_6x8, White);
-                }
-            }
-            break;
-            
-        case MENU_GRAPHICS:
-            Display_Graphics();
-            return; // Graphics has its own display logic
-            
-        case MENU_ABOUT:
-            ssd1306_SetCursor(0, 0);
-            ssd1306_WriteString("Power Meter v1.0", Font_7x10, White);
-            ssd1306_SetCursor(0, 12);
-            ssd1306_WriteString("STM32L053R8", Font_6x8, White);
-            ssd1306_SetCursor(0, 20);
-            ssd1306_WriteString("Test Development", Font_6x8, White);
-            ssd1306_SetCursor(0, 28);
-            ssd1306_WriteString("Board - INSA-GE", Font_6x8, White);
-            break;
+    if (button_state) {
+        button_long_press_handled = 1;
     }
-    
-    ssd1306_UpdateScreen();
+    return button_state;
 }
 
 /**
@@ -530,159 +263,183 @@ void Update_Graphics_Data(void)
     uint32_t current_time = HAL_GetTick();
     
     // Update data every 200ms for smooth animation
-    if (current_time - last_graph_update > 200) {
-        voltage_history[graph_data_index] = simulated_voltage;
-        current_history[graph_data_index] = simulated_current;
-        power_history[graph_data_index] = simulated_power;
-        
-        graph_data_index = (graph_data_index + 1) % GRAPH_DATA_POINTS;
+    if (current_time - last_graph_update > HISTORY_BASE_PERIOD_MS) {
+        History_Push(simulated_voltage, simulated_current, simulated_power, current_time);
         last_graph_update = current_time;
     }
 }
 
 /**
-  * @brief  Display graphics curve
+  * @brief  Run the capture sampler only while the scope screen is shown
   */
-void Display_Graphics(void)
+static void Update_Scope_Sampler(void)
 {
-    char title_str[21] = {0};
-    float max_value = 0.0f;
-    float min_value = 0.0f;
-    float* data_array;
-    
-    // Clear screen
-    ssd1306_Fill(Black);
-    
-    // Select data source and find min/max for scaling
-    if (graphics_parameter == 0) {
-        // Voltage - use integer formatting
-        int v_int = (int)simulated_voltage;
-        int v_frac = (int)((simulated_voltage - v_int) * 10.0f);
-        sprintf(title_str, "Voltage: %d.%dV", v_int, v_frac);
-        data_array = voltage_history;
-        max_value = 30.0f;  // Max voltage range
-        min_value = 0.0f;
-    } else if (graphics_parameter == 1) {
-        // Current - use integer formatting
-        int i_int = (int)simulated_current;
-        int i_frac = (int)((simulated_current - i_int) * 100.0f);
-        sprintf(title_str, "Current: %d.%02dA", i_int, i_frac);
-        data_array = current_history;
-        max_value = 5.0f;   // Max current range
-        min_value = 0.0f;
-    } else {
-        // Power - use integer formatting
-        int p_int = (int)simulated_power;
-        int p_frac = (int)((simulated_power - p_int) * 10.0f);
-        sprintf(title_str, "Power: %d.%dW", p_int, p_frac);
-        data_array = power_history;
-        max_value = 150.0f;  // Max power range (30V * 5A = 150W)
-        min_value = 0.0f;
-    }
-    
-    // Display title
-    ssd1306_SetCursor(0, 0);
-    ssd1306_WriteString(title_str, Font_6x8, White);
-    
-    // Draw graph area (leaving space for title and axis labels)
-    uint8_t graph_height = 20;  // Graph height in pixels
-    uint8_t graph_y_offset = 10; // Start Y position for graph
-    
-    // Draw axes
-    // Y-axis
-    for (uint8_t y = 0; y < graph_height; y++) {
-        ssd1306_DrawPixel(10, graph_y_offset + y, White);
+    if (Menu_Get_Screen() == MENU_SCOPE && !scope_sampler_running) {
+        Scope_Arm();
+        HAL_TIM_Base_Start_IT(&htim21);
+        scope_sampler_running = 1;
+    } else if (Menu_Get_Screen() != MENU_SCOPE && scope_sampler_running) {
+        HAL_TIM_Base_Stop_IT(&htim21);
+        Scope_Stop();
+        scope_sampler_running = 0;
     }
-    // X-axis
-    for (uint8_t x = 0; x < 110; x++) {
-        ssd1306_DrawPixel(10 + x, graph_y_offset + graph_height - 1, White);
-    }
-    
-    // Plot data points
-    for (uint8_t i = 0; i < GRAPH_DATA_POINTS - 1; i++) {
-        uint8_t data_index = (graph_data_index + i) % GRAPH_DATA_POINTS;
-        uint8_t next_index = (graph_data_index + i + 1) % GRAPH_DATA_POINTS;
-        
-        // Scale values to fit graph
-        uint8_t y1 = graph_y_offset + graph_height - 1 - 
-                     (uint8_t)((data_array[data_index] / max_value) * (graph_height - 2));
-        uint8_t y2 = graph_y_offset + graph_height - 1 - 
-                     (uint8_t)((data_array[next_index] / max_value) * (graph_height - 2));
-        
-        uint8_t x1 = 11 + (i * 110) / (GRAPH_DATA_POINTS - 1);
-        uint8_t x2 = 11 + ((i + 1) * 110) / (GRAPH_DATA_POINTS - 1);
-        
-        // Draw line between points
-        ssd1306_Line(x1, y1, x2, y2, White);
-    }
-    
-    // Add scale labels
-    ssd1306_SetCursor(0, graph_y_offset);
-    if (graphics_parameter == 0) {
-        ssd1306_WriteString("30", Font_6x8, White);  // Voltage
-    } else if (graphics_parameter == 1) {
-        ssd1306_WriteString("5", Font_6x8, White);   // Current
-    } else {
-        ssd1306_WriteString("150", Font_6x8, White); // Power
-    }
-    
-    ssd1306_SetCursor(0, graph_y_offset + graph_height - 8);
-    ssd1306_WriteString("0", Font_6x8, White);
-    
-    ssd1306_UpdateScreen();
 }
 
 /**
-  * @brief  Display power meter data (separated from menu system)
+  * @brief  Accept the pending button level once it held for the debounce time
+  * @param  now Tick of the next button or encoder event, or the current tick
+  * @note   A short press is confirmed when the release is accepted
   */
-void Display_Power_Meter(void)
+static void Button_Settle(uint32_t now)
 {
-    char line1_str[21] = {0};
-    char line2_str[21] = {0};
-    char line3_str[21] = {0};
-    
-    // Convert float to integer parts for display (avoiding %f)
-    // Voltage: XX.X format (1 decimal place)
-    int v_int = (int)simulated_voltage;
-    int v_frac = (int)((simulated_voltage - v_int) * 10.0f);
-    if (v_frac < 0) v_frac = -v_frac;
-    
-    // Current: X.XX format (2 decimal places)  
-    int i_int = (int)simulated_current;
-    int i_frac = (int)((simulated_current - i_int) * 100.0f);
-    if (i_frac < 0) i_frac = -i_frac;
-    
-    // Power: XXX.X format (1 decimal place)
-    int p_int = (int)simulated_power;
-    int p_frac = (int)((simulated_power - p_int) * 10.0f);
-    if (p_frac < 0) p_frac = -p_frac;
-    
-    // Energy handling
-    if (accumulated_energy < 1.0f) {
-        // Display in Wh for small values (integer Wh)
-        int e_wh = (int)(accumulated_energy * 1000.0f);
-        sprintf(line1_str, "V:%d.%dV  I:%d.%02dA", v_int, v_frac, i_int, i_frac);
-        sprintf(line2_str, "P:%d.%dW E:%dWh", p_int, p_frac, e_wh);
-    } else {
-        // Display in kWh for larger values (X.XXX format)
-        int e_int = (int)accumulated_energy;
-        int e_frac = (int)((accumulated_energy - e_int) * 1000.0f);
-        if (e_frac < 0) e_frac = -e_frac;
-        sprintf(line1_str, "V:%d.%dV  I:%d.%02dA", v_int, v_frac, i_int, i_frac);
-        sprintf(line2_str, "P:%d.%dW E:%d.%03dkWh", p_int, p_frac, e_int, e_frac);
-    }
-    
-    sprintf(line3_str, "ROT:%03u BTN:%s", rotary_counter, button_state ? "ON " : "OFF");
-    
-    // Clear screen and display power meter data
-    ssd1306_Fill(Black);
-    ssd1306_SetCursor(0, 0);
-    ssd1306_WriteString(line1_str, Font_7x10, White);
-    ssd1306_SetCursor(0, 11);
-    ssd1306_WriteString(line2_str, Font_7x10, White);
-    ssd1306_SetCursor(0, 22);
-    ssd1306_WriteString(line3_str, Font_6x8, White);
-    ssd1306_UpdateScreen();
+	if (!button_pending || (int32_t)(now - button_pending_time) < BUTTON_DEBOUNCE_MS) {
+		return;
+	}
+	button_pending = 0;
+	
+	if (button_pending_level && !button_state) {
+		// Button pressed
+		button_press_time = button_pending_time;
+		button_long_press_handled = 0;
+		button_state = 1;
+	}
+	else if (!button_pending_level && button_state) {
+		// Button released
+		uint32_t press_duration = button_pending_time - button_press_time;
+		
+		if (!button_long_press_handled && press_duration < 2000) {
+			// Short press only if long press wasn't already handled
+			Handle_Menu_Action(0); // Short press
+		}
+		button_state = 0;
+	}
+}
+
+/**
+  * @brief  Decode an encoder edge into detents
+  * @param  rotary_new Pin levels of the edge, ROT_CHA << 1 | ROT_CHB
+  * @param  time Tick of the edge
+  */
+static void Rotary_Decode(uint8_t rotary_new, uint32_t time)
+{
+	static int8_t rotary_buffer = 0;
+	int8_t direction = 0;
+	
+	// Software debouncing: ignore edges within 5ms of the last one
+	if ((time - rotary_last_event_time) < ROTARY_DEBOUNCE_MS) {
+		return;
+	}
+	rotary_last_event_time = time;
+	
+	if (rotary_new == rotary_state) {
+		return;
+	}
+	
+	// Clockwise state transitions
+	if (((rotary_state == 0b00) && (rotary_new == 0b10)) || 
+	    ((rotary_state == 0b10) && (rotary_new == 0b11)) ||
+	    ((rotary_state == 0b11) && (rotary_new == 0b01)) || 
+	    ((rotary_state == 0b01) && (rotary_new == 0b00))) {
+		rotary_buffer++;
+	}
+	
+	// Counter-clockwise state transitions
+	if (((rotary_state == 0b00) && (rotary_new == 0b01)) || 
+	    ((rotary_state == 0b01) && (rotary_new == 0b11)) ||
+	    ((rotary_state == 0b11) && (rotary_new == 0b10)) || 
+	    ((rotary_state == 0b10) && (rotary_new == 0b00))) {
+		rotary_buffer--;
+	}
+	
+	rotary_state = rotary_new;
+	
+	// Check if we have enough transitions for a full detent
+	if (rotary_buffer > 3) {
+		rotary_counter++;
+		rotary_buffer = 0;
+		direction = 1;  // Clockwise
+	}
+	if (rotary_buffer < -3) {
+		rotary_counter--;
+		rotary_buffer = 0;
+		direction = -1; // Counter-clockwise
+	}
+	
+	if (direction != 0) {
+		Handle_Menu_Navigation(direction);
+	}
+}
+
+#if ROTARY_HW_ENCODER
+/**
+  * @brief  Turn the detents counted by TIM2 since the last tick into navigation
+  * @note   Contact bounce moves the count forward and back by the same
+  *         edges, so it cancels out without a debounce time; steps are
+  *         kept until they make a whole detent
+  */
+static void Rotary_Poll(void)
+{
+	static int16_t rotary_steps = 0;
+	uint16_t count = __HAL_TIM_GET_COUNTER(&htim2);
+	
+	rotary_steps += (int16_t)(count - rotary_last_count);
+	rotary_last_count = count;
+	
+	while (rotary_steps >= ROTARY_COUNTS_PER_DETENT) {
+		rotary_steps -= ROTARY_COUNTS_PER_DETENT;
+		rotary_counter++;
+		Handle_Menu_Navigation(1);   // Clockwise
+	}
+	while (rotary_steps <= -ROTARY_COUNTS_PER_DETENT) {
+		rotary_steps += ROTARY_COUNTS_PER_DETENT;
+		rotary_counter--;
+		Handle_Menu_Navigation(-1);  // Counter-clockwise
+	}
+}
+#endif
+
+/**
+  * @brief  Run the input events queued by the encoder and button interrupts
+  * @param  now Current tick in milliseconds
+  * @note   Both queues are merged in time order, so press-and-turn sees the
+  *         button as it was when the encoder turned
+  */
+static void Process_Input_Events(uint32_t now)
+{
+	const Input_Event_t* rotary;
+	const Input_Event_t* button;
+	
+	for (;;) {
+		rotary = Input_Peek(&rotary_queue);
+		button = Input_Peek(&button_queue);
+		if (rotary == NULL && button == NULL) {
+			break;
+		}
+		
+		if (button == NULL || (rotary != NULL && (int16_t)(rotary->time - button->time) <= 0)) {
+			uint32_t time = Input_Event_Time(rotary, now);
+			uint8_t value = rotary->value;
+			
+			Input_Pop(&rotary_queue);
+			Button_Settle(time);
+			Rotary_Decode(value, time);
+		} else {
+			uint32_t time = Input_Event_Time(button, now);
+			
+			// The last level of a burst of bounces is the one kept
+			Button_Settle(time);
+			button_pending_level = button->value;
+			button_pending_time = time;
+			button_pending = 1;
+			Input_Pop(&button_queue);
+		}
+	}
+	Button_Settle(now);
+	
+#if ROTARY_HW_ENCODER
+	// No encoder interrupts: the detents since the last tick, after the button events
+	Rotary_Poll();
+#endif
 }
 
 /**
@@ -714,9 +471,15 @@ void Timer_Interrupt_Handler(void)
 	// Update peak values
 	Update_Peaks(simulated_voltage, simulated_current, simulated_power);
 	
+	// Update power distribution (one counter per sample)
+	Histogram_Add(simulated_power);
+	
 	// Update graphics data buffer
 	Update_Graphics_Data();
 	
+	// Menu logic of the inputs queued since the last tick
+	Process_Input_Events(current_timestamp);
+	
 	// Check for button long press (moved from interrupt to timer for stability)
 	if (button_state && !button_long_press_handled) {
 		uint32_t press_duration = current_timestamp - button_press_time;
@@ -728,136 +491,101 @@ void Timer_Interrupt_Handler(void)
 	}
 	
 	// Check for auto-return to power meter (30 seconds timeout)
-	if (current_menu != MENU_POWER_METER && 
+	if (Menu_Get_Screen() != MENU_POWER_METER && 
 	    (current_timestamp - last_activity_time) > 30000) {
-		current_menu = MENU_POWER_METER;
-		menu_selection = 0;
+		Menu_Set_Screen(MENU_POWER_METER, 0);
 		menu_changed = 1;
 	}
 	
-	// Update display for all menu states to prevent screen freeze during transitions
-	if (menu_changed) {
-		Display_Current_Menu();
-		menu_changed = 0;
+	// Start or stop the scope sampler on menu changes
+	Update_Scope_Sampler();
+	
+	// A failed display is left to the main loop, measurement goes on without it
+	if (ssd1306_IsDegraded()) {
+		display_degraded = 1;
+	}
+	if (display_degraded) {
+		return;
+	}
+	
+	// Change the display bus speed while no frame is on the bus
+	if (i2c_requested_profile != I2C_Timing_Get_Profile() && !ssd1306_IsFrameInFlight()) {
+		if (I2C_Timing_Apply(&hi2c1, i2c_requested_profile) == HAL_ERROR) {
+			i2c_requested_profile = I2C_Timing_Get_Profile();  // Clock too slow for this mode
+			menu_changed = 1;
+		}
 	}
-	// Always update power meter and graphics display for real-time data
-	else if (current_menu == MENU_POWER_METER || current_menu == MENU_GRAPHICS) {
+	
+	// Draw when the screen changed or its frame rate asks for a frame, and
+	// never while the previous frame is still on the bus
+	if (Render_Frame_Due(Menu_Get_Screen(), menu_changed, current_timestamp)) {
+		// The menu state only changes in this handler, a frame is always complete
+		menu_changed = 0;
 		Display_Current_Menu();
+		ssd1306_UpdateScreenAsync();
+		Render_Frame_Done();
+		Screens_Record_Flush(ssd1306_GetLastFlushBytes());
 	}
+	// Send what a frame refused while the previous one was in flight left behind
+	else {
+		ssd1306_UpdateScreenAsync();
+	}
+}
+
+/**
+  * @brief  Interrupt handler for TIM21 timer
+  * @note	Samples both channels at SCOPE_SAMPLE_RATE_HZ for the scope capture
+  */
+void Sampling_Timer_Interrupt_Handler(void)
+{
+	uint32_t voltage = Get_ADC_Value(ADC_CHANNEL_10);
+	uint32_t current = Get_ADC_Value(ADC_CHANNEL_11);
+	
+	Scope_Add_Sample((uint16_t)voltage, (uint16_t)current);
 }
 
 /**
   * @brief  Interrupt handler for User Button GPIO
-  * @note	This function handles button press/release with enhanced debouncing
+  * @note	Queues the button level for the measurement tick, which debounces it
   *         - Short press: Enter/confirm menu action
   *         - Long press (>2s): Back/exit menu action
   */
 void User_Button_Interrupt_Handler(void)
 {
-	uint32_t current_time = HAL_GetTick();
-	uint8_t raw_button_state = HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin);
-	
-	// Software debouncing: ignore interrupts within 20ms of last interrupt
-	if ((current_time - button_last_interrupt_time) < 20) {
-		return;
-	}
-	button_last_interrupt_time = current_time;
-	
-	// Only process if state actually changed from stable state
-	if (raw_button_state == button_stable_state) {
-		return;
-	}
-	
-	// State has changed and is stable
-	button_stable_state = raw_button_state;
-	
-	if (button_stable_state && !button_state) {
-		// Button pressed (rising edge after debouncing)
-		button_press_time = current_time;
-		button_long_press_handled = 0;
-		button_state = 1;
-	}
-	else if (!button_stable_state && button_state) {
-		// Button released (falling edge after debouncing)
-		uint32_t press_duration = current_time - button_press_time;
-		
-		if (!button_long_press_handled && press_duration < 2000) {
-			// Short press only if long press wasn't already handled
-			Handle_Menu_Action(0); // Short press
-		}
-		button_state = 0;
-	}
+	Input_Push(&button_queue, INPUT_BUTTON,
+	           HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin), HAL_GetTick());
 }
 
 /**
   * @brief  Interrupt handler for Rotary Encoder Channel A
-  * @note	This function is called when edges are detected on rotary encoder channels
-  *         Uses software debouncing instead of HAL_Delay for better stability
+  * @note	Queues the levels of both channels for the measurement tick,
+  *         which debounces and decodes them
   */
 void Rotary_Encoder_Interrupt_Handler(void)
 {
-	static int8_t rotary_buffer = 0;
-	uint32_t current_time = HAL_GetTick();
-	
-	// Software debouncing: ignore interrupts within 5ms of last interrupt
-	if ((current_time - rotary_last_interrupt_time) < 5) {
-		return;
-	}
-	rotary_last_interrupt_time = current_time;
-	
-	// Read encoder state
 	uint8_t rotary_new = HAL_GPIO_ReadPin(ROT_CHA_GPIO_Port, ROT_CHA_Pin) << 1;
-	rotary_new += HAL_GPIO_ReadPin(ROT_CHB_GPIO_Port, ROT_CHB_Pin);
 	
-	if (rotary_new != rotary_state) {
-		int8_t direction = 0;
-		
-		// Clockwise state transitions
-		if (((rotary_state == 0b00) && (rotary_new == 0b10)) || 
-		    ((rotary_state == 0b10) && (rotary_new == 0b11)) ||
-		    ((rotary_state == 0b11) && (rotary_new == 0b01)) || 
-		    ((rotary_state == 0b01) && (rotary_new == 0b00))) {
-			rotary_buffer++;
-		}
-		
-		// Counter-clockwise state transitions
-		if (((rotary_state == 0b00) && (rotary_new == 0b01)) || 
-		    ((rotary_state == 0b01) && (rotary_new == 0b11)) ||
-		    ((rotary_state == 0b11) && (rotary_new == 0b10)) || 
-		    ((rotary_state == 0b10) && (rotary_new == 0b00))) {
-			rotary_buffer--;
-		}
-		
-		rotary_state = rotary_new;
-		
-		// Check if we have enough transitions for a full detent
-		if (rotary_buffer > 3) {
-			rotary_counter++;
-			rotary_buffer = 0;
-			direction = 1;  // Clockwise
-		}
-		if (rotary_buffer < -3) {
-			rotary_counter--;
-			rotary_buffer = 0;
-			direction = -1; // Counter-clockwise
-		}
-		
-		// Handle menu navigation if we detected a direction change
-		if (direction != 0) {
-			Handle_Menu_Navigation(direction);
-		}
-	}
+	rotary_new += HAL_GPIO_ReadPin(ROT_CHB_GPIO_Port, ROT_CHB_Pin);
+	Input_Push(&rotary_queue, INPUT_ROTARY, rotary_new, HAL_GetTick());
 }
 
 /**
   * @brief  Start a conversion and return the value converted.
-  * @note   This function waits for the end of conversion in a blocking way
+  * @note   This function waits for the end of conversion in a blocking way.
+  *         The TIM21 sampler, which preempts the TIM6 tick, is held off
+  *         meanwhile so the two handlers cannot interleave their conversions.
+  *         Only that interrupt is disabled: SysTick keeps the HAL timeouts
+  *         running and the display DMA and I2C interrupts keep being served
   * @param  hadc ADC handle
   * @param  adc_channel Channel macro such as ADC_CHANNEL_0, ADC_CHANNEL_1, etc.
   * @retval Channel converted value
   */
 uint32_t Get_ADC_Value(uint32_t adc_channel)
 {
+	uint32_t sampler_enabled = NVIC_GetEnableIRQ(TIM21_IRQn);
+	uint32_t value;
+	
+	HAL_NVIC_DisableIRQ(TIM21_IRQn);
 	/* Disable all previous channel configuration */
 	hadc.Instance->CHSELR = 0;
 	ADC_ChannelConfTypeDef sConfig = {0};
@@ -875,7 +603,11 @@ uint32_t Get_ADC_Value(uint32_t adc_channel)
 	{
 		Error_Handler();
 	}
-	return HAL_ADC_GetValue(&hadc);
+	value = HAL_ADC_GetValue(&hadc);
+	if (sampler_enabled) {
+		HAL_NVIC_EnableIRQ(TIM21_IRQn);
+	}
+	return value;
 }
 /* USER CODE END 0 */
 
@@ -908,10 +640,16 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_ADC_Init();
   MX_I2C1_Init();
   MX_TIM6_Init();
+  MX_TIM21_Init();
   /* USER CODE BEGIN 2 */
+#if ROTARY_HW_ENCODER
+  Rotary_Encoder_Timer_Init();
+#endif
+  
   // Initialize OLED display
   ssd1306_Init();
   ssd1306_Fill(Black);
@@ -926,10 +664,11 @@ int main(void)
   last_activity_time = HAL_GetTick();
   Reset_Energy();
   Reset_Peaks();
+  History_Reset();
+  Histogram_Reset();
   
   // Initialize menu system
-  current_menu = MENU_POWER_METER;
-  menu_selection = 0;
+  Screens_Init();
   menu_changed = 1;
   
   // Start timer for periodic measurements
@@ -949,6 +688,11 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+    // Bring a failed display back, retrying at a slow pace if it stays down
+    if (display_degraded &&
+        (display_recovery_log.count == 0 || (HAL_GetTick() - display_recovery_log.last_tick) >= DISPLAY_RETRY_MS)) {
+        Display_Recover();
+    }
   }
   /* USER CODE END 3 */
 }
@@ -1110,7 +854,11 @@ static void MX_I2C1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN I2C1_Init 2 */
-
+  // Replace the generated constant with timings computed from the actual clock
+  if (I2C_Timing_Apply(&hi2c1, I2C_PROFILE_DEFAULT) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END I2C1_Init 2 */
 
 }
@@ -1153,6 +901,67 @@ static void MX_TIM6_Init(void)
 
 }
 
+/**
+  * @brief TIM21 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM21_Init(void)
+{
+
+  /* USER CODE BEGIN TIM21_Init 0 */
+
+  /* USER CODE END TIM21_Init 0 */
+
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* USER CODE BEGIN TIM21_Init 1 */
+
+  /* USER CODE END TIM21_Init 1 */
+  htim21.Instance = TIM21;
+  htim21.Init.Prescaler = 31;
+  htim21.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim21.Init.Period = 999;
+  htim21.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim21.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim21) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim21, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim21, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN TIM21_Init 2 */
+
+  /* USER CODE END TIM21_Init 2 */
+
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel2_3_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel2_3_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -1201,6 +1010,148 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+#if ROTARY_HW_ENCODER
+/**
+  * @brief  Count the rotary encoder with TIM2 in encoder mode
+  * @note   Both edges of both channels count (x4), up when ROT_CHA leads,
+  *         the direction the software decoder calls clockwise. Glitches
+  *         shorter than the input filter are ignored
+  */
+static void Rotary_Encoder_Timer_Init(void)
+{
+  TIM_Encoder_InitTypeDef sConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = 0;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = 0xFFFF;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV4;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  sConfig.EncoderMode = TIM_ENCODERMODE_TI12;
+  sConfig.IC1Polarity = TIM_ICPOLARITY_RISING;
+  sConfig.IC1Selection = TIM_ICSELECTION_DIRECTTI;
+  sConfig.IC1Prescaler = TIM_ICPSC_DIV1;
+  sConfig.IC1Filter = ROTARY_INPUT_FILTER;
+  sConfig.IC2Polarity = TIM_ICPOLARITY_RISING;
+  sConfig.IC2Selection = TIM_ICSELECTION_DIRECTTI;
+  sConfig.IC2Prescaler = TIM_ICPSC_DIV1;
+  sConfig.IC2Filter = ROTARY_INPUT_FILTER;
+  if (HAL_TIM_Encoder_Init(&htim2, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_ALL) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  rotary_last_count = __HAL_TIM_GET_COUNTER(&htim2);
+}
+#endif
+
+/**
+  * @brief  Wait about half a clock period of a 100 kHz bus
+  */
+static void Display_Bus_Delay(void)
+{
+    for (volatile uint32_t i = SystemCoreClock / 1000000; i > 0; i--) {
+    }
+}
+
+/**
+  * @brief  Free a bus held low by the display
+  * @note   Nine SCL clocks let a slave stuck mid-byte shift it out and see a
+  *         NACK, then a STOP resets its bus logic. I2C1 must be deinitialized
+  */
+static void Display_Bus_Clear(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    
+    HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin | DISPLAY_SDA_Pin, GPIO_PIN_SET);
+    GPIO_InitStruct.Pin = DISPLAY_SCL_Pin | DISPLAY_SDA_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(DISPLAY_I2C_GPIO_Port, &GPIO_InitStruct);
+    Display_Bus_Delay();
+    
+    for (uint8_t i = 0; i < 9; i++) {
+        HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin, GPIO_PIN_RESET);
+        Display_Bus_Delay();
+        HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin, GPIO_PIN_SET);
+        Display_Bus_Delay();
+    }
+    
+    // STOP condition: SDA rises while SCL is high
+    HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SDA_Pin, GPIO_PIN_RESET);
+    Display_Bus_Delay();
+    HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin, GPIO_PIN_SET);
+    Display_Bus_Delay();
+    HAL_GPIO_WritePin(DISPLAY_I2C_GPIO_Port, DISPLAY_SDA_Pin, GPIO_PIN_SET);
+    Display_Bus_Delay();
+    
+    HAL_GPIO_DeInit(DISPLAY_I2C_GPIO_Port, DISPLAY_SCL_Pin | DISPLAY_SDA_Pin);
+}
+
+/**
+  * @brief  Clear the bus, restart I2C1 and the display, and log the cost
+  * @note   Runs from the main loop: the timer handler keeps measuring and
+  *         skips the display until display_degraded is cleared
+  */
+static void Display_Recover(void)
+{
+    uint32_t start = HAL_GetTick();
+    uint32_t duration;
+    
+    HAL_I2C_DeInit(&hi2c1);
+    Display_Bus_Clear();
+    MX_I2C1_Init();     // Back to the default profile, the timer handler reapplies the selected one
+    ssd1306_Init();
+    Screens_Invalidate();   // The screenbuffer was cleared
+    
+    duration = HAL_GetTick() - start;
+    display_recovery_log.count++;
+    display_recovery_log.last_tick = start;
+    display_recovery_log.last_ms = duration;
+    display_recovery_log.total_ms += duration;
+    if (duration > display_recovery_log.max_ms) {
+        display_recovery_log.max_ms = duration;
+    }
+    
+    if (ssd1306_IsDegraded()) {
+        display_recovery_log.failures++;
+    } else {
+        menu_changed = 1;
+        display_degraded = 0;
+    }
+}
+
+/**
+  * @brief  Memory write completed, continues the display frame in flight
+  */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == &SSD1306_I2C_PORT) {
+        ssd1306_TransferCompleteCallback();
+    }
+}
+
+/**
+  * @brief  I2C error, the display frame in flight is dropped and resent
+  */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == &SSD1306_I2C_PORT) {
+        ssd1306_TransferErrorCallback();
+    }
+}
 
 /* USER CODE END 4 */
 
@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file           : menu.c
+  * @brief          : Table-driven menu navigation and rendering
+  ******************************************************************************
+  */
+
+#include "menu.h"
+#include "ssd1306/ssd1306.h"
+
+#define MENU_LINE_CHARS 21    // Font_6x8 characters across the screen
+
+static const Menu_Screen_t* menu_screens;
+static uint8_t menu_count;
+static uint8_t menu_home;
+
+static uint8_t menu_screen;
+static uint8_t menu_selection;
+
+/**
+  * @brief  Set the screen table and show the home screen
+  * @param  screens Descriptor of each screen, indexed by screen number
+  * @param  count Number of screens in the table
+  * @param  home Screen of the long press, its parent is entered from itself
+  */
+void Menu_Init(const Menu_Screen_t* screens, uint8_t count, uint8_t home)
+{
+    menu_screens = screens;
+    menu_count = count;
+    menu_home = home;
+    Menu_Set_Screen(home, 0);
+}
+
+/**
+  * @brief  Show a screen
+  * @param  screen Screen number, ignored when outside the table
+  * @param  selection Item selected on a list screen, or position kept for a view
+  */
+void Menu_Set_Screen(uint8_t screen, uint8_t selection)
+{
+    if (screen >= menu_count) return;
+    menu_screen = screen;
+    menu_selection = selection;
+}
+
+uint8_t Menu_Get_Screen(void)
+{
+    return menu_screen;
+}
+
+uint8_t Menu_Get_Selection(void)
+{
+    return menu_selection;
+}
+
+/**
+  * @brief  Move the selection of a list screen, wrapping at both ends
+  * @param  direction 1 for clockwise, -1 for counter-clockwise
+  */
+void Menu_Turn(int8_t direction)
+{
+    const Menu_Screen_t* screen = &menu_screens[menu_screen];
+
+    if (screen->items == NULL) {
+        if (screen->turn != NULL) screen->turn(direction);
+        return;
+    }
+    if (direction > 0) {
+        menu_selection = (menu_selection + 1 < screen->count) ? menu_selection + 1 : 0;
+    } else {
+        menu_selection = (menu_selection > 0) ? menu_selection - 1 : screen->count - 1;
+    }
+}
+
+/**
+  * @brief  Confirm the selected item, or leave a view for its parent
+  */
+void Menu_Press(void)
+{
+    const Menu_Screen_t* screen = &menu_screens[menu_screen];
+    const Menu_Item_t* item;
+
+    if (screen->items == NULL) {
+        if (screen->press == NULL || !screen->press()) {
+            Menu_Set_Screen(screen->parent, screen->parent_selection);
+        }
+        return;
+    }
+    if (menu_selection >= screen->count) return;
+    item = &screen->items[menu_selection];
+
+    if (item->action != NULL) {
+        item->action();
+    }
+    if (item->target == MENU_BACK) {
+        Menu_Set_Screen(screen->parent, screen->parent_selection);
+    } else if (item->target != MENU_STAY) {
+        Menu_Set_Screen(item->target, 0);
+    }
+}
+
+/**
+  * @brief  Go home, or from home to its parent
+  */
+void Menu_Long_Press(void)
+{
+    if (menu_screen == menu_home) {
+        Menu_Set_Screen(menu_screens[menu_home].parent, 0);
+    } else {
+        Menu_Set_Screen(menu_home, 0);
+    }
+}
+
+/**
+  * @brief  Draw the current screen into the cleared screenbuffer
+  * @note   A list shows MENU_VISIBLE_ITEMS rows, keeping the selection in
+  *         the middle row when it can, with scroll marks on the right
+  */
+void Menu_Draw(void)
+{
+    const Menu_Screen_t* screen = &menu_screens[menu_screen];
+    uint8_t start_item = 0;
+    char line[MENU_LINE_CHARS + 1];
+    Format_Buffer_t out;
+
+    if (screen->items == NULL) {
+        if (screen->draw != NULL) screen->draw();
+        return;
+    }
+
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString((char*)screen->title, Font_6x8, White);
+
+    if (screen->count > MENU_VISIBLE_ITEMS && menu_selection >= 2) {
+        start_item = menu_selection - 1;
+        if (start_item > screen->count - MENU_VISIBLE_ITEMS) start_item = screen->count - MENU_VISIBLE_ITEMS;
+    }
+
+    for (uint8_t i = 0; i < MENU_VISIBLE_ITEMS && (start_item + i) < screen->count; i++) {
+        const Menu_Item_t* item = &screen->items[start_item + i];
+
+        Format_Begin(&out, line, sizeof(line));
+        Format_Text(&out, (start_item + i == menu_selection) ? ">" : " ");
+        Format_Text(&out, item->label);
+        if (item->value != NULL) {
+            item->value(&out);
+        }
+        ssd1306_SetCursor(0, 8 + (i * 8));
+        ssd1306_WriteString(line, Font_6x8, White);
+    }
+
+    if (start_item > 0) {
+        ssd1306_SetCursor(120, 8);
+        ssd1306_WriteString("^", Font_6x8, White);
+    }
+    if (start_item + MENU_VISIBLE_ITEMS < screen->count) {
+        ssd1306_SetCursor(120, 24);
+        ssd1306_WriteString("v", Font_6x8, White);
+    }
+}
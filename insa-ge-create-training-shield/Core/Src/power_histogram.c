@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : power_histogram.c
+  * @brief          : Incremental power distribution histogram
+  ******************************************************************************
+  */
+
+#include "power_histogram.h"
+
+static uint32_t histogram_counts[HISTOGRAM_BINS];
+static uint32_t histogram_total = 0;
+
+/**
+  * @brief  Clear all bins
+  */
+void Histogram_Reset(void)
+{
+    for (uint8_t bin = 0; bin < HISTOGRAM_BINS; bin++) {
+        histogram_counts[bin] = 0;
+    }
+    histogram_total = 0;
+}
+
+/**
+  * @brief  Record one power sample
+  * @param  power Power in watts, values above full scale go to the last bin
+  */
+void Histogram_Add(float power)
+{
+    uint32_t bin = 0;
+
+    if (power > 0.0f) {
+        bin = (uint32_t)(power * (HISTOGRAM_BINS / (float)HISTOGRAM_FULL_SCALE_W));
+        if (bin >= HISTOGRAM_BINS) bin = HISTOGRAM_BINS - 1;
+    }
+
+    // Counters saturate instead of wrapping so percentiles stay meaningful
+    if (histogram_total != UINT32_MAX) {
+        histogram_counts[bin]++;
+        histogram_total++;
+    }
+}
+
+/**
+  * @brief  Number of recorded samples
+  */
+uint32_t Histogram_Get_Total(void)
+{
+    return histogram_total;
+}
+
+/**
+  * @brief  Count of one bin in a view with fewer bins
+  * @param  bin Bin index in the view
+  * @param  bins Number of bins in the view (power of two, <= HISTOGRAM_BINS)
+  */
+uint32_t Histogram_Get_Count(uint8_t bin, uint8_t bins)
+{
+    uint8_t group = HISTOGRAM_BINS / bins;
+    uint32_t count = 0;
+
+    for (uint8_t i = 0; i < group; i++) {
+        count += histogram_counts[bin * group + i];
+    }
+    return count;
+}
+
+/**
+  * @brief  Largest bin count in a view, used to scale the bar chart
+  */
+uint32_t Histogram_Get_Max_Count(uint8_t bins)
+{
+    uint32_t max_count = 0;
+
+    for (uint8_t bin = 0; bin < bins; bin++) {
+        uint32_t count = Histogram_Get_Count(bin, bins);
+        if (count > max_count) max_count = count;
+    }
+    return max_count;
+}
+
+/**
+  * @brief  Power below which a given share of the samples falls
+  * @param  percent Percentile, 1-100
+  * @retval Upper edge of the percentile bin in tenths of a watt, 0 if empty
+  */
+uint16_t Histogram_Get_Percentile(uint8_t percent)
+{
+    uint64_t target = (uint64_t)histogram_total * percent;
+    uint64_t cumulative = 0;
+
+    if (histogram_total == 0) return 0;
+
+    for (uint8_t bin = 0; bin < HISTOGRAM_BINS; bin++) {
+        cumulative += histogram_counts[bin];
+        if (cumulative * 100 >= target) {
+            return (uint16_t)((bin + 1) * HISTOGRAM_FULL_SCALE_W * 10 / HISTOGRAM_BINS);
+        }
+    }
+    return HISTOGRAM_FULL_SCALE_W * 10;
+}
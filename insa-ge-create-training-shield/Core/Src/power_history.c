@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file           : power_history.c
+  * @brief          : Multi-resolution measurement history for the graph screen
+  ******************************************************************************
+  */
+
+#include "power_history.h"
+
+typedef struct {
+    History_Sample_t buckets[HISTORY_DEPTH];
+    History_Sample_t pending;      // First half of the pair feeding the next level
+    uint32_t newest_time;          // Timestamp of the last sample in the newest bucket
+    uint16_t head;                 // Index of the next bucket to write
+    uint16_t count;                // Number of valid buckets
+    uint8_t has_pending;
+} History_Level_t;
+
+static History_Level_t history_levels[HISTORY_LEVELS];
+
+/**
+  * @brief  Convert a physical value to a saturated fixed-point value
+  */
+static uint16_t History_To_Fixed(float value, uint16_t scale)
+{
+    float scaled = value * (float)scale + 0.5f;
+
+    if (scaled <= 0.0f) return 0;
+    if (scaled >= 65535.0f) return 65535;
+    return (uint16_t)scaled;
+}
+
+/**
+  * @brief  Store a bucket in one level and propagate pairs to the levels above
+  * @note   Each level does at most one write, so a push costs O(HISTORY_LEVELS)
+  */
+static void History_Store(uint8_t level, History_Sample_t sample, uint32_t timestamp)
+{
+    while (level < HISTORY_LEVELS) {
+        History_Level_t* lvl = &history_levels[level];
+
+        lvl->buckets[lvl->head] = sample;
+        lvl->head = (lvl->head + 1) % HISTORY_DEPTH;
+        if (lvl->count < HISTORY_DEPTH) lvl->count++;
+        lvl->newest_time = timestamp;
+
+        if (!lvl->has_pending) {
+            lvl->pending = sample;
+            lvl->has_pending = 1;
+            return;
+        }
+
+        // Second bucket of a pair: the rounded mean becomes one bucket of the next level
+        sample.voltage = (uint16_t)(((uint32_t)lvl->pending.voltage + sample.voltage + 1) / 2);
+        sample.current = (uint16_t)(((uint32_t)lvl->pending.current + sample.current + 1) / 2);
+        sample.power = (uint16_t)(((uint32_t)lvl->pending.power + sample.power + 1) / 2);
+        lvl->has_pending = 0;
+        level++;
+    }
+}
+
+/**
+  * @brief  Clear all history levels
+  */
+void History_Reset(void)
+{
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++) {
+        history_levels[level].head = 0;
+        history_levels[level].count = 0;
+        history_levels[level].has_pending = 0;
+        history_levels[level].newest_time = 0;
+    }
+}
+
+/**
+  * @brief  Append one base period sample to the history
+  * @param  voltage Voltage in volts
+  * @param  current Current in amperes
+  * @param  power Power in watts
+  * @param  timestamp Tick of the sample in milliseconds
+  */
+void History_Push(float voltage, float current, float power, uint32_t timestamp)
+{
+    History_Sample_t sample;
+
+    sample.voltage = History_To_Fixed(voltage, HISTORY_VOLTAGE_SCALE);
+    sample.current = History_To_Fixed(current, HISTORY_CURRENT_SCALE);
+    sample.power = History_To_Fixed(power, HISTORY_POWER_SCALE);
+
+    History_Store(0, sample, timestamp);
+}
+
+/**
+  * @brief  Number of valid buckets stored in a level
+  */
+uint16_t History_Count(uint8_t level)
+{
+    if (level >= HISTORY_LEVELS) return 0;
+    return history_levels[level].count;
+}
+
+/**
+  * @brief  Read one bucket of a level
+  * @param  level Decimation level (factor 1 << level)
+  * @param  age Bucket age, 0 being the newest bucket
+  * @retval Pointer to the bucket, NULL if it has not been recorded yet
+  */
+const History_Sample_t* History_Get(uint8_t level, uint16_t age)
+{
+    const History_Level_t* lvl;
+
+    if (level >= HISTORY_LEVELS) return 0;
+    lvl = &history_levels[level];
+    if (age >= lvl->count) return 0;
+
+    return &lvl->buckets[(lvl->head + HISTORY_DEPTH - 1 - age) % HISTORY_DEPTH];
+}
+
+/**
+  * @brief  Time elapsed since the end of a bucket
+  * @param  level Decimation level (factor 1 << level)
+  * @param  age Bucket age, 0 being the newest bucket
+  * @param  now Current tick in milliseconds
+  * @retval Age in milliseconds
+  */
+uint32_t History_Get_Age_Ms(uint8_t level, uint16_t age, uint32_t now)
+{
+    if (level >= HISTORY_LEVELS) return 0;
+
+    return (now - history_levels[level].newest_time) +
+           (uint32_t)age * ((uint32_t)HISTORY_BASE_PERIOD_MS << level);
+}
@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @file           : render_scheduler.c
+  * @brief          : Display frame rate governor
+  ******************************************************************************
+  */
+
+#include "render_scheduler.h"
+#include "ssd1306/ssd1306.h"
+
+static const uint8_t* render_target_fps;   // Target of each screen
+static Render_Stats_t* render_stats;       // Statistics of each screen
+static uint8_t render_screens;
+
+static uint8_t render_screen = 0xFF;       // Screen being scheduled, 0xFF before the first frame
+static uint32_t render_next_due;           // Tick of the next periodic frame
+static uint32_t render_window_start;
+static uint16_t render_window_frames;
+
+/**
+  * @brief  Set the per-screen targets and the statistics they update
+  * @param  target_fps Frame rate of each screen, RENDER_FPS_ON_CHANGE for static screens
+  * @param  stats Statistics of each screen, cleared here
+  * @param  screens Number of screens in both tables
+  */
+void Render_Init(const uint8_t* target_fps, Render_Stats_t* stats, uint8_t screens)
+{
+    render_target_fps = target_fps;
+    render_stats = stats;
+    render_screens = screens;
+    render_screen = 0xFF;
+
+    for (uint8_t i = 0; i < screens; i++) {
+        stats[i].fps_x10 = 0;
+        stats[i].dropped = 0;
+    }
+}
+
+/**
+  * @brief  Decide whether the current screen should be drawn on this tick
+  * @param  screen Screen shown now
+  * @param  changed The screen content changed and must be redrawn
+  * @param  now Current tick in milliseconds
+  * @retval 1 to draw a frame now, then call Render_Frame_Done
+  * @note   Changes are never dropped, they wait for the bus like any frame
+  *         and are drawn on the first tick it is free
+  */
+uint8_t Render_Frame_Due(uint8_t screen, uint8_t changed, uint32_t now)
+{
+    uint8_t periodic = 0;
+    uint32_t elapsed;
+
+    if (screen >= render_screens) return changed;
+
+    // A new screen starts its schedule and frame rate window now
+    if (screen != render_screen) {
+        render_screen = screen;
+        render_next_due = now;
+        render_window_start = now;
+        render_window_frames = 0;
+        changed = 1;
+    }
+
+    elapsed = now - render_window_start;
+    if (elapsed >= RENDER_FPS_WINDOW_MS) {
+        render_stats[screen].fps_x10 = (uint16_t)((render_window_frames * 10000UL + elapsed / 2) / elapsed);
+        render_window_start = now;
+        render_window_frames = 0;
+    }
+
+    if (render_target_fps[screen] != RENDER_FPS_ON_CHANGE && (int32_t)(now - render_next_due) >= 0) {
+        uint32_t period = 1000UL / render_target_fps[screen];
+
+        // Keep the average rate on a coarse tick, but do not catch up after a stall
+        render_next_due += period;
+        if ((int32_t)(now - render_next_due) >= 0) {
+            render_next_due = now + period;
+        }
+        periodic = 1;
+    }
+
+    if (!changed && !periodic) return 0;
+
+    if (ssd1306_IsFrameInFlight()) {
+        if (periodic) render_stats[screen].dropped++;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  Count a frame drawn after Render_Frame_Due allowed it
+  */
+void Render_Frame_Done(void)
+{
+    render_window_frames++;
+}
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file           : scope_capture.c
+  * @brief          : Triggered waveform capture with pre-trigger buffer
+  ******************************************************************************
+  */
+
+#include "scope_capture.h"
+
+static Scope_Sample_t scope_ring[SCOPE_DEPTH];
+static volatile uint16_t scope_head = 0;       // Index of the next sample to write
+static volatile uint16_t scope_filled = 0;     // Valid samples since arming
+static volatile uint16_t scope_remaining = 0;  // Post-trigger samples still to record
+static volatile Scope_State_t scope_state = SCOPE_STOPPED;
+static uint16_t scope_last_value = 0;
+
+static Scope_Config_t scope_config = {
+    SCOPE_SOURCE_CURRENT,
+    SCOPE_EDGE_RISING,
+    SCOPE_ADC_FULL_SCALE / 2,
+    SCOPE_DEPTH / 4
+};
+
+/**
+  * @brief  Replace the trigger configuration and restart the capture if running
+  */
+void Scope_Set_Config(const Scope_Config_t* config)
+{
+    scope_config = *config;
+    if (scope_config.pretrigger >= SCOPE_DEPTH) {
+        scope_config.pretrigger = SCOPE_DEPTH - 1;
+    }
+    if (scope_state != SCOPE_STOPPED) {
+        Scope_Arm();
+    }
+}
+
+/**
+  * @brief  Current trigger configuration
+  */
+const Scope_Config_t* Scope_Get_Config(void)
+{
+    return &scope_config;
+}
+
+/**
+  * @brief  Discard the ring and wait for a new trigger
+  */
+void Scope_Arm(void)
+{
+    scope_state = SCOPE_STOPPED;   // Keeps the sampler out while resetting
+    scope_head = 0;
+    scope_filled = 0;
+    scope_remaining = 0;
+    scope_state = SCOPE_ARMED;
+}
+
+/**
+  * @brief  Stop recording, the last capture stays readable
+  */
+void Scope_Stop(void)
+{
+    scope_state = SCOPE_STOPPED;
+}
+
+/**
+  * @brief  Raw value of the configured trigger source
+  */
+uint16_t Scope_Get_Value(const Scope_Sample_t* sample)
+{
+    return (scope_config.source == SCOPE_SOURCE_VOLTAGE) ? sample->voltage : sample->current;
+}
+
+/**
+  * @brief  Record one sample, called from the sampling timer interrupt
+  * @param  voltage Raw ADC value of the voltage channel
+  * @param  current Raw ADC value of the current channel
+  */
+void Scope_Add_Sample(uint16_t voltage, uint16_t current)
+{
+    Scope_State_t state = scope_state;
+    uint16_t previous = scope_last_value;
+    uint16_t value;
+
+    if (state != SCOPE_ARMED && state != SCOPE_TRIGGERED) {
+        return;
+    }
+
+    scope_ring[scope_head].voltage = voltage;
+    scope_ring[scope_head].current = current;
+    scope_head = (scope_head + 1) % SCOPE_DEPTH;
+    value = Scope_Get_Value(&scope_ring[(scope_head + SCOPE_DEPTH - 1) % SCOPE_DEPTH]);
+    scope_last_value = value;
+
+    if (state == SCOPE_TRIGGERED) {
+        if (--scope_remaining == 0) {
+            scope_state = SCOPE_DONE;
+        }
+        return;
+    }
+
+    // Only trigger once the pre-trigger part of the ring is filled, and
+    // never on the first sample after arming: previous then holds a value
+    // of the last capture, or of the other channel
+    if (scope_filled < scope_config.pretrigger || scope_filled == 0) {
+        scope_filled++;
+        return;
+    }
+
+    if ((scope_config.edge == SCOPE_EDGE_RISING && previous < scope_config.level && value >= scope_config.level) ||
+        (scope_config.edge == SCOPE_EDGE_FALLING && previous > scope_config.level && value <= scope_config.level)) {
+        // The trigger sample is stored, M - 1 samples still follow it
+        scope_filled = SCOPE_DEPTH;
+        scope_remaining = SCOPE_DEPTH - scope_config.pretrigger - 1;
+        scope_state = (scope_remaining == 0) ? SCOPE_DONE : SCOPE_TRIGGERED;
+    }
+}
+
+/**
+  * @brief  Current capture state
+  */
+Scope_State_t Scope_Get_State(void)
+{
+    return scope_state;
+}
+
+/**
+  * @brief  Read the capture in chronological order
+  * @param  index 0 is the oldest sample, SCOPE_DEPTH - 1 the newest. In a
+  *         frozen capture the trigger sample sits at index pretrigger
+  * @retval Pointer to the sample
+  */
+const Scope_Sample_t* Scope_Get_Sample(uint16_t index)
+{
+    return &scope_ring[(scope_head + index) % SCOPE_DEPTH];
+}
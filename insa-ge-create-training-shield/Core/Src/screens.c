@@ -0,0 +1,1042 @@
+/**
+  ******************************************************************************
+  * @file           : screens.c
+  * @brief          : Screens of the power meter and their views
+  ******************************************************************************
+  */
+
+#include "screens.h"
+#include <stddef.h>
+#include "main.h"
+#include "ssd1306/ssd1306.h"
+#include "ssd1306/ssd1306_icons.h"
+#include "power_history.h"
+#include "power_histogram.h"
+#include "scope_capture.h"
+#include "text_field.h"
+#include "render_scheduler.h"
+#include "fixed_format.h"
+#include "menu.h"
+
+// Target frame rate of each screen, the measurement tick only draws when a frame is due
+static const uint8_t screen_target_fps[MENU_COUNT] = {
+    4,                      // MENU_POWER_METER: numbers are unreadable above a few changes per second
+    RENDER_FPS_ON_CHANGE,   // MENU_MAIN
+    RENDER_FPS_ON_CHANGE,   // MENU_PEAKS
+    15,                     // MENU_GRAPHICS
+    RENDER_FPS_ON_CHANGE,   // MENU_GRAPHICS_SELECT
+    RENDER_FPS_ON_CHANGE,   // MENU_SETTINGS
+    RENDER_FPS_ON_CHANGE,   // MENU_RESET
+    RENDER_FPS_ON_CHANGE,   // MENU_ABOUT
+    4,                      // MENU_HISTOGRAM
+    15,                     // MENU_SCOPE
+    RENDER_FPS_ON_CHANGE,   // MENU_SCOPE_SETTINGS
+    2                       // MENU_DIAGNOSTICS
+};
+static Render_Stats_t render_stats[MENU_COUNT];
+static uint16_t screen_flush_bytes[MENU_COUNT]; // I2C bytes of the last frame of each screen
+
+// Power meter views (short press cycles)
+#define POWER_VIEW_NUMERIC 0    // Text readout
+#define POWER_VIEW_GAUGE   1    // Power gauge with V/I bar meters
+#define POWER_VIEW_BIG     2    // V, I and P in big digits, readable from a distance
+#define POWER_VIEW_COUNT   3
+static uint8_t power_meter_view = POWER_VIEW_NUMERIC;
+
+// Text views of the power meter, described as retained fields so a frame
+// only redraws the characters that changed
+#define POWER_VIEW_NONE   POWER_VIEW_COUNT
+static uint8_t power_view_drawn = POWER_VIEW_NONE;  // Text view held by the screenbuffer
+static uint8_t power_alarm_drawn = 0;               // Alarm icon shown by the text view
+
+enum { METER_VOLTAGE, METER_CURRENT, METER_POWER, METER_ENERGY, METER_ROTARY, METER_BUTTON, METER_FIELDS };
+static const Text_Field_Def_t meter_fields[METER_FIELDS] = {
+    {0,  0,  &Font_7x10, "V:",   "V",  1, 0,               5},
+    {63, 0,  &Font_7x10, "I:",   "A",  2, 0,               5},
+    {0,  11, &Font_7x10, "P:",   "W",  1, 0,               6},
+    {58, 11, &Font_7x10, "E:",   NULL, 0, 0,               8},  // Wh or kWh, ends on the right edge
+    {0,  22, &Font_6x8,  "ROT:", NULL, 0, FORMAT_ZERO_PAD, 3},
+    {48, 22, &Font_6x8,  "BTN:", NULL, 0, 0,               3}
+};
+static char meter_shown[METER_FIELDS][TEXT_FIELD_MAX_CHARS];
+// Energy in Wh from which the kWh value no longer fits with 0 to 3 decimals.
+// 99999 kWh, the last that fits, takes 76 years at the 150 W full scale
+static const int32_t energy_decimals_limit[4] = {99999500, 999950, 99995, 10000};
+static const Text_Screen_t meter_screen = {meter_fields, meter_shown, METER_FIELDS};
+
+// Big numbers view: fields on page boundaries, so a changed character
+// is one whole-byte glyph write
+#define BIG_CHAR_WIDTH    11    // Font_Digits_11x16
+enum { BIG_VOLTAGE, BIG_CURRENT, BIG_POWER, BIG_FIELDS };
+static const Text_Field_Def_t big_fields[BIG_FIELDS] = {
+    {0,                                      0,  &Font_Digits_11x16, NULL, "V", 1, 0, 5},
+    {SSD1306_WIDTH - 5 * BIG_CHAR_WIDTH,     0,  &Font_Digits_11x16, NULL, "A", 2, 0, 5},
+    {(SSD1306_WIDTH - 6 * BIG_CHAR_WIDTH) / 2, 16, &Font_Digits_11x16, NULL, "W", 1, 0, 6}
+};
+static char big_shown[BIG_FIELDS][TEXT_FIELD_MAX_CHARS];
+static const Text_Screen_t big_screen = {big_fields, big_shown, BIG_FIELDS};
+
+// Gauge view layout, angles follow ssd1306_DrawArc (0 degree points down)
+#define GAUGE_X           30    // Needle pivot
+#define GAUGE_Y           31
+#define GAUGE_RADIUS      28
+#define GAUGE_LEFT_ANGLE  270   // Zero of the scale
+#define GAUGE_RIGHT_ANGLE 90    // Full scale (HISTOGRAM_FULL_SCALE_W)
+#define GAUGE_TICKS       4     // Scale divisions
+#define BAR_X             72    // Left edge of the V/I bar meters
+#define BAR_WIDTH         55
+
+// Graphics functionality variables
+#define GRAPH_DATA_POINTS 64  // Number of data points for graph (64 points across 128 pixel width)
+#define GRAPH_PAN_STEP    4   // Buckets moved per encoder detent while panning
+#define GRAPH_X_START     11  // First plotted column (Y-axis sits one column left)
+#define GRAPH_WIDTH       110 // Plot width in pixels
+#define GRAPH_Y_OFFSET    10  // Start Y position for graph
+#define GRAPH_HEIGHT      20  // Graph height in pixels
+#define GRAPH_MODE_OVERLAY  3   // Voltage and current on independent scales
+#define GRAPH_MODE_XY       4   // Current plotted against voltage
+static uint8_t graphics_parameter = 0;  // 0 = Voltage, 1 = Current, 2 = Power, 3 = V+I, 4 = I-V
+static uint8_t graph_zoom_level = 0;    // History level shown, decimation factor 1 << level
+static uint16_t graph_pan_offset = 0;   // Age of the bucket under the cursor (right edge)
+static uint8_t histogram_view_bins = HISTOGRAM_BINS;  // Bars shown on the histogram screen
+
+#define DIAG_ROWS 6             // Meter, Graph, Histogram, Scope, recoveries, recovery time
+
+// Scope screen variables
+#define SCOPE_Y_BOTTOM    31    // Screen row of a zero sample
+#define SCOPE_HEIGHT      22    // Waveform height in pixels (rows 9 to 31)
+#define SCOPE_LEVEL_STEP  128   // Trigger level change per encoder detent (raw ADC units)
+#define SCOPE_MAX_ZOOM    3     // Horizontal zoom 1x, 2x, 4x, 8x
+static uint8_t scope_zoom_level = 0;    // Pixels per sample = 1 << level
+
+static void Display_Peaks(void);
+static void Display_About(void);
+
+/**
+  * @brief  Change the graph decimation factor, keeping the cursor time
+  * @param  direction: 1 to zoom out (x2), -1 to zoom in (/2)
+  */
+void Graphics_Zoom(int8_t direction)
+{
+    uint8_t old_level = graph_zoom_level;
+    uint16_t count;
+
+    if (direction > 0 && graph_zoom_level < HISTORY_LEVELS - 1) {
+        graph_zoom_level++;
+    } else if (direction < 0 && graph_zoom_level > 0) {
+        graph_zoom_level--;
+    }
+
+    // Same point in time, expressed in buckets of the new level
+    graph_pan_offset = ((uint32_t)graph_pan_offset << old_level) >> graph_zoom_level;
+    count = History_Count(graph_zoom_level);
+    if (graph_pan_offset >= count) {
+        graph_pan_offset = (count > 0) ? count - 1 : 0;
+    }
+}
+
+/**
+  * @brief  Move the graph cursor through the stored history
+  * @param  direction: 1 towards the present, -1 back in time
+  */
+void Graphics_Pan(int8_t direction)
+{
+    uint16_t count = History_Count(graph_zoom_level);
+
+    if (direction > 0) {
+        graph_pan_offset = (graph_pan_offset > GRAPH_PAN_STEP) ? graph_pan_offset - GRAPH_PAN_STEP : 0;
+    } else {
+        graph_pan_offset += GRAPH_PAN_STEP;
+        if (graph_pan_offset >= count) {
+            graph_pan_offset = (count > 0) ? count - 1 : 0;
+        }
+    }
+}
+
+/**
+  * @brief  Leave the power meter for its next view on a short press
+  */
+static uint8_t Power_Meter_Press(void)
+{
+    // Cycle through the numeric, gauge and big numbers views
+    power_meter_view = (power_meter_view + 1) % POWER_VIEW_COUNT;
+    return 1;
+}
+
+/**
+  * @brief  Open the graph of the selected parameter
+  * @note   Graphics menu items 0 to GRAPH_MODE_XY are the graphics parameters
+  */
+static void Graphics_Open(void)
+{
+    graphics_parameter = Menu_Get_Selection();
+    graph_pan_offset = 0;
+}
+
+/**
+  * @brief  Zoom the graph, or pan it while the button is held
+  */
+static void Graphics_Turn(int8_t direction)
+{
+    if (Button_Held_For_Turn()) {
+        // Press-and-turn pans
+        Graphics_Pan(direction);
+    } else {
+        Graphics_Zoom(direction);
+    }
+}
+
+/**
+  * @brief  Return to the graphics menu on the parameter shown
+  */
+static uint8_t Graphics_Press(void)
+{
+    Menu_Set_Screen(MENU_GRAPHICS_SELECT, graphics_parameter);
+    return 1;
+}
+
+/**
+  * @brief  Select the number of bars (32, 16 or 8), the recorded bins are kept
+  */
+static void Histogram_Turn(int8_t direction)
+{
+    if (direction > 0 && histogram_view_bins > HISTOGRAM_MIN_BINS) {
+        histogram_view_bins /= 2;
+    } else if (direction < 0 && histogram_view_bins < HISTOGRAM_BINS) {
+        histogram_view_bins *= 2;
+    }
+}
+
+/**
+  * @brief  Zoom the capture, or move the trigger level while the button is held
+  */
+static void Scope_Turn(int8_t direction)
+{
+    if (Button_Held_For_Turn()) {
+        // Press-and-turn moves the trigger level
+        Scope_Adjust_Level(direction);
+    } else if (direction > 0 && scope_zoom_level < SCOPE_MAX_ZOOM) {
+        scope_zoom_level++;
+    } else if (direction < 0 && scope_zoom_level > 0) {
+        scope_zoom_level--;
+    }
+}
+
+/**
+  * @brief  Take the next capture when one is on hold, otherwise leave the scope
+  */
+static uint8_t Scope_Press(void)
+{
+    if (Scope_Get_State() == SCOPE_DONE) {
+        Scope_Arm();
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  Scroll the diagnostics rows, 3 are visible
+  */
+static void Diagnostics_Turn(int8_t direction)
+{
+    uint8_t row = Menu_Get_Selection();
+    
+    if (direction > 0 && row < DIAG_ROWS - 3) {
+        Menu_Set_Screen(MENU_DIAGNOSTICS, row + 1);
+    } else if (direction < 0 && row > 0) {
+        Menu_Set_Screen(MENU_DIAGNOSTICS, row - 1);
+    }
+}
+
+static void I2C_Speed_Value(Format_Buffer_t* out)
+{
+    Format_Text(out, I2C_Timing_Get_Name(i2c_requested_profile));
+}
+
+static void I2C_Speed_Next(void)
+{
+    i2c_requested_profile = (i2c_requested_profile + 1) % I2C_PROFILE_COUNT;
+}
+
+static void Scope_Source_Value(Format_Buffer_t* out)
+{
+    Format_Text(out, (Scope_Get_Config()->source == SCOPE_SOURCE_VOLTAGE) ? "V" : "I");
+}
+
+static void Scope_Source_Next(void)
+{
+    Scope_Config_t config = *Scope_Get_Config();
+    
+    config.source = (config.source == SCOPE_SOURCE_VOLTAGE) ? SCOPE_SOURCE_CURRENT : SCOPE_SOURCE_VOLTAGE;
+    Scope_Set_Config(&config);
+}
+
+static void Scope_Edge_Value(Format_Buffer_t* out)
+{
+    Format_Text(out, (Scope_Get_Config()->edge == SCOPE_EDGE_RISING) ? "Rising" : "Falling");
+}
+
+static void Scope_Edge_Next(void)
+{
+    Scope_Config_t config = *Scope_Get_Config();
+    
+    config.edge = (config.edge == SCOPE_EDGE_RISING) ? SCOPE_EDGE_FALLING : SCOPE_EDGE_RISING;
+    Scope_Set_Config(&config);
+}
+
+static void Scope_Pretrigger_Value(Format_Buffer_t* out)
+{
+    Format_Int(out, Scope_Get_Config()->pretrigger, 0, 0);
+}
+
+/**
+  * @brief  Cycle the pre-trigger samples from 1/8 to 3/4 of the capture
+  */
+static void Scope_Pretrigger_Next(void)
+{
+    Scope_Config_t config = *Scope_Get_Config();
+    
+    config.pretrigger = (config.pretrigger >= SCOPE_DEPTH * 3 / 4) ?
+                        SCOPE_DEPTH / 8 : config.pretrigger + SCOPE_DEPTH / 8;
+    Scope_Set_Config(&config);
+}
+
+// List screens, in flash; the item order is the selection number
+static const Menu_Item_t main_items[] = {
+    {" Power Meter",   NULL, NULL, MENU_POWER_METER},
+    {" Peak Values",   NULL, NULL, MENU_PEAKS},
+    {" Graphics",      NULL, NULL, MENU_GRAPHICS_SELECT},
+    {" Settings",      NULL, NULL, MENU_SETTINGS},
+    {" Reset Options", NULL, NULL, MENU_RESET}
+};
+
+static const Menu_Item_t graphics_items[] = {
+    {" Voltage (V)",   NULL, Graphics_Open, MENU_GRAPHICS},   // Items 0 to GRAPH_MODE_XY
+    {" Current (A)",   NULL, Graphics_Open, MENU_GRAPHICS},   // follow graphics_parameter
+    {" Power (W)",     NULL, Graphics_Open, MENU_GRAPHICS},
+    {" V+I Overlay",   NULL, Graphics_Open, MENU_GRAPHICS},
+    {" I-V (XY)",      NULL, Graphics_Open, MENU_GRAPHICS},
+    {" Histogram (P)", NULL, NULL,          MENU_HISTOGRAM},
+    {" Scope",         NULL, NULL,          MENU_SCOPE},
+    {" Back",          NULL, NULL,          MENU_BACK}
+};
+
+static const Menu_Item_t settings_items[] = {
+    {" About",         NULL,            NULL,           MENU_ABOUT},
+    {" Scope Trigger", NULL,            NULL,           MENU_SCOPE_SETTINGS},
+    {" I2C Speed: ",   I2C_Speed_Value, I2C_Speed_Next, MENU_STAY},
+    {" Diagnostics",   NULL,            NULL,           MENU_DIAGNOSTICS},
+    {" Back",          NULL,            NULL,           MENU_BACK}
+};
+
+static const Menu_Item_t scope_items[] = {
+    {" Source: ",      Scope_Source_Value,     Scope_Source_Next,     MENU_STAY},
+    {" Edge: ",        Scope_Edge_Value,       Scope_Edge_Next,       MENU_STAY},
+    {" Pre-trig: ",    Scope_Pretrigger_Value, Scope_Pretrigger_Next, MENU_STAY},
+    {" Back",          NULL,                   NULL,                  MENU_BACK}
+};
+
+static const Menu_Item_t reset_items[] = {
+    {" Reset Peaks",     NULL, Reset_Peaks,     MENU_BACK},
+    {" Reset Energy",    NULL, Reset_Energy,    MENU_BACK},
+    {" Reset Histogram", NULL, Histogram_Reset, MENU_BACK},
+    {" Cancel",          NULL, NULL,            MENU_BACK}
+};
+
+#define MENU_LIST(items) items, sizeof(items) / sizeof(items[0])
+
+// Every screen: lists are drawn by the menu engine, views by their hooks.
+// A view or Back item returns to its parent with the item that opened it selected
+static const Menu_Screen_t menu_screens[MENU_COUNT] = {
+    [MENU_POWER_METER]     = {NULL, NULL, 0, MENU_MAIN, 0,
+                              Display_Power_Meter, NULL, Power_Meter_Press},
+    [MENU_MAIN]            = {"=== MAIN MENU ===", MENU_LIST(main_items), MENU_POWER_METER, 0,
+                              NULL, NULL, NULL},
+    [MENU_PEAKS]           = {NULL, NULL, 0, MENU_MAIN, 1,
+                              Display_Peaks, NULL, NULL},
+    [MENU_GRAPHICS]        = {NULL, NULL, 0, MENU_GRAPHICS_SELECT, 0,
+                              Display_Graphics, Graphics_Turn, Graphics_Press},
+    [MENU_GRAPHICS_SELECT] = {"=== GRAPHICS ===", MENU_LIST(graphics_items), MENU_MAIN, 2,
+                              NULL, NULL, NULL},
+    [MENU_SETTINGS]        = {"=== SETTINGS ===", MENU_LIST(settings_items), MENU_MAIN, 3,
+                              NULL, NULL, NULL},
+    [MENU_RESET]           = {"=== RESET ===", MENU_LIST(reset_items), MENU_MAIN, 4,
+                              NULL, NULL, NULL},
+    [MENU_ABOUT]           = {NULL, NULL, 0, MENU_SETTINGS, 0,
+                              Display_About, NULL, NULL},
+    [MENU_HISTOGRAM]       = {NULL, NULL, 0, MENU_GRAPHICS_SELECT, 5,
+                              Display_Histogram, Histogram_Turn, NULL},
+    [MENU_SCOPE]           = {NULL, NULL, 0, MENU_GRAPHICS_SELECT, 6,
+                              Display_Scope, Scope_Turn, Scope_Press},
+    [MENU_SCOPE_SETTINGS]  = {"== SCOPE TRIG ==", MENU_LIST(scope_items), MENU_SETTINGS, 1,
+                              NULL, NULL, NULL},
+    [MENU_DIAGNOSTICS]     = {NULL, NULL, 0, MENU_SETTINGS, 3,
+                              Display_Diagnostics, Diagnostics_Turn, NULL}
+};
+
+/**
+  * @brief  Start the menu on the power meter and the frame rate governor on the screen table
+  */
+void Screens_Init(void)
+{
+    Render_Init(screen_target_fps, render_stats, MENU_COUNT);
+    Menu_Init(menu_screens, MENU_COUNT, MENU_POWER_METER);
+}
+
+/**
+  * @brief  Redraw the whole screen on the next frame, after the screenbuffer was cleared
+  */
+void Screens_Invalidate(void)
+{
+    power_view_drawn = POWER_VIEW_NONE;
+}
+
+/**
+  * @brief  Keep the I2C bytes of the frame just flushed for the diagnostics screen
+  */
+void Screens_Record_Flush(uint16_t bytes)
+{
+    screen_flush_bytes[Menu_Get_Screen()] = bytes;
+}
+
+/**
+  * @brief  Display current menu on OLED
+  */
+void Display_Current_Menu(void)
+{
+    // Text views of the power meter keep their screen and redraw changed characters only
+    if (Menu_Get_Screen() == MENU_POWER_METER && power_meter_view != POWER_VIEW_GAUGE) {
+        Display_Power_Meter();
+        return;
+    }
+    power_view_drawn = POWER_VIEW_NONE;
+    
+    ssd1306_Fill(Black);
+    Menu_Draw();
+}
+
+/**
+  * @brief  Display the peak values since the last reset
+  */
+static void Display_Peaks(void)
+{
+    char line[21];
+    Format_Buffer_t out;
+    
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("=== PEAK VALUES ===", Font_6x8, White);
+    
+    Format_Begin(&out, line, sizeof(line));
+    Format_Text(&out, "V: ");
+    Format_Fixed(&out, Format_From_Float(peak_voltage, 1), 1, 1, 0, 0);
+    Format_Text(&out, "V");
+    ssd1306_SetCursor(0, 10);
+    ssd1306_WriteString(line, Font_7x10, White);
+    
+    Format_Begin(&out, line, sizeof(line));
+    Format_Text(&out, "I: ");
+    Format_Fixed(&out, Format_From_Float(peak_current, 2), 2, 2, 0, 0);
+    Format_Text(&out, "A");
+    ssd1306_SetCursor(0, 20);
+    ssd1306_WriteString(line, Font_7x10, White);
+    
+    Format_Begin(&out, line, sizeof(line));
+    Format_Text(&out, "P: ");
+    Format_Fixed(&out, Format_From_Float(peak_power, 1), 1, 1, 0, 0);
+    Format_Text(&out, "W");
+    ssd1306_SetCursor(70, 20);
+    ssd1306_WriteString(line, Font_7x10, White);
+}
+
+/**
+  * @brief  Display the board and firmware identification
+  */
+static void Display_About(void)
+{
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("Power Meter v1.0", Font_7x10, White);
+    ssd1306_SetCursor(0, 12);
+    ssd1306_WriteString("STM32L053R8", Font_6x8, White);
+    ssd1306_SetCursor(0, 20);
+    ssd1306_WriteString("Test Development", Font_6x8, White);
+    ssd1306_SetCursor(0, 28);
+    ssd1306_WriteString("Board - INSA-GE", Font_6x8, White);
+}
+
+/**
+  * @brief  Display render and display bus statistics
+  * @note   Rows show achieved/target frame rate, dropped frames and the
+  *         bytes of the last frame of each live screen, then the recoveries
+  */
+void Display_Diagnostics(void)
+{
+    static const struct {
+        const char* name;
+        uint8_t screen;
+    } diag_screens[4] = {
+        {"Meter", MENU_POWER_METER},
+        {"Graph", MENU_GRAPHICS},
+        {"Histo", MENU_HISTOGRAM},
+        {"Scope", MENU_SCOPE}
+    };
+    char line[22];
+    Format_Buffer_t out;
+    
+    // Columns: name, achieved/target fps, dropped frames, I2C bytes of the last frame
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("DIAG  fps/tg drp  I2C", Font_6x8, White);
+    
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t row = Menu_Get_Selection() + i;
+        
+        Format_Begin(&out, line, sizeof(line));
+        if (row < 4) {
+            uint8_t screen = diag_screens[row].screen;
+            const Render_Stats_t* stats = &render_stats[screen];
+            
+            Format_Text(&out, diag_screens[row].name);
+            Format_Pad(&out, 5);
+            Format_Fixed(&out, stats->fps_x10, 1, 1, 4, 0);
+            Format_Text(&out, "/");
+            Format_Int(&out, screen_target_fps[screen], 2, FORMAT_LEFT);
+            Format_Text(&out, " ");
+            Format_Int(&out, (stats->dropped > 999) ? 999 : stats->dropped, 3, 0);
+            Format_Text(&out, " ");
+            Format_Int(&out, screen_flush_bytes[screen], 4, 0);
+        } else if (row == 4) {
+            Format_Text(&out, "Recover ");
+            Format_Int(&out, (int32_t)display_recovery_log.count, 0, 0);
+            Format_Text(&out, " fail ");
+            Format_Int(&out, (int32_t)display_recovery_log.failures, 0, 0);
+        } else {
+            Format_Text(&out, "Recov ");
+            Format_Int(&out, (int32_t)display_recovery_log.last_ms, 0, 0);
+            Format_Text(&out, "/");
+            Format_Int(&out, (int32_t)display_recovery_log.max_ms, 0, 0);
+            Format_Text(&out, "ms max");
+        }
+        ssd1306_SetCursor(0, 8 + (i * 8));
+        ssd1306_WriteString(line, Font_6x8, White);
+    }
+}
+
+
+/**
+  * @brief  Value of a graph parameter in history units
+  */
+static uint16_t Graphics_Sample_Value(const History_Sample_t* sample, uint8_t parameter)
+{
+    if (parameter == 0) return sample->voltage;
+    if (parameter == 1) return sample->current;
+    return sample->power;
+}
+
+/**
+  * @brief  Full scale of a graph parameter in history units
+  */
+static uint16_t Graphics_Full_Scale(uint8_t parameter)
+{
+    if (parameter == 0) return 30 * HISTORY_VOLTAGE_SCALE;   // Max voltage range
+    if (parameter == 1) return 5 * HISTORY_CURRENT_SCALE;    // Max current range
+    return 150 * HISTORY_POWER_SCALE;                        // Max power range (30V * 5A = 150W)
+}
+
+/**
+  * @brief  Append a history value of a graph parameter with its unit
+  * @note   History units have one more digit than shown (HISTORY_*_SCALE)
+  */
+static void Graphics_Format_Value(Format_Buffer_t* out, uint16_t value, uint8_t parameter)
+{
+    if (parameter == 0) {
+        Format_Fixed(out, value, 2, 1, 0, 0);
+        Format_Text(out, "V");
+    } else if (parameter == 1) {
+        Format_Fixed(out, value, 3, 2, 0, 0);
+        Format_Text(out, "A");
+    } else {
+        Format_Fixed(out, value, 2, 1, 0, 0);
+        Format_Text(out, "W");
+    }
+}
+
+/**
+  * @brief  Append the age and decimation factor of the graph cursor, " -m:ss xN"
+  */
+static void Graphics_Format_Cursor(Format_Buffer_t* out, uint32_t age_s)
+{
+    Format_Text(out, " -");
+    Format_Int(out, (int32_t)(age_s / 60), 0, 0);
+    Format_Text(out, ":");
+    Format_Int(out, (int32_t)(age_s % 60), 2, FORMAT_ZERO_PAD);
+    Format_Text(out, " x");
+    Format_Int(out, 1 << graph_zoom_level, 0, 0);
+}
+
+/**
+  * @brief  Screen row of a value inside the graph area
+  */
+static uint8_t Graphics_Scale_Y(uint16_t value, uint16_t full_scale)
+{
+    if (value > full_scale) value = full_scale;
+    return GRAPH_Y_OFFSET + GRAPH_HEIGHT - 1 - 
+           (uint8_t)((uint32_t)value * (GRAPH_HEIGHT - 2) / full_scale);
+}
+
+/**
+  * @brief  Plot one parameter as a time trace
+  * @param  parameter 0 = Voltage, 1 = Current, 2 = Power
+  * @param  dotted 0 joins the points with lines, 1 only plots the points
+  */
+static void Graphics_Plot_Trace(uint8_t parameter, uint8_t dotted)
+{
+    uint16_t full_scale = Graphics_Full_Scale(parameter);
+    
+    // Oldest on the left; buckets not recorded yet are skipped
+    for (uint8_t i = 0; i < GRAPH_DATA_POINTS - 1; i++) {
+        const History_Sample_t* s1 = History_Get(graph_zoom_level, graph_pan_offset + GRAPH_DATA_POINTS - 1 - i);
+        const History_Sample_t* s2 = History_Get(graph_zoom_level, graph_pan_offset + GRAPH_DATA_POINTS - 2 - i);
+        if (s1 == NULL || s2 == NULL) {
+            continue;
+        }
+        
+        uint8_t y1 = Graphics_Scale_Y(Graphics_Sample_Value(s1, parameter), full_scale);
+        uint8_t y2 = Graphics_Scale_Y(Graphics_Sample_Value(s2, parameter), full_scale);
+        uint8_t x1 = GRAPH_X_START + (i * GRAPH_WIDTH) / (GRAPH_DATA_POINTS - 1);
+        uint8_t x2 = GRAPH_X_START + ((i + 1) * GRAPH_WIDTH) / (GRAPH_DATA_POINTS - 1);
+        
+        if (dotted) {
+            ssd1306_DrawPixel(x1, y1, White);
+            ssd1306_DrawPixel(x2, y2, White);
+        } else {
+            ssd1306_Line(x1, y1, x2, y2, White);
+        }
+    }
+}
+
+/**
+  * @brief  Plot current against voltage for the buckets in view
+  */
+static void Graphics_Plot_XY(void)
+{
+    uint16_t v_scale = Graphics_Full_Scale(0);
+    uint16_t i_scale = Graphics_Full_Scale(1);
+    
+    for (uint8_t i = 0; i < GRAPH_DATA_POINTS; i++) {
+        const History_Sample_t* sample = History_Get(graph_zoom_level, graph_pan_offset + i);
+        if (sample == NULL) {
+            break;
+        }
+        
+        uint16_t v = (sample->voltage > v_scale) ? v_scale : sample->voltage;
+        uint8_t x = GRAPH_X_START + (uint8_t)((uint32_t)v * (GRAPH_WIDTH - 1) / v_scale);
+        uint8_t y = Graphics_Scale_Y(sample->current, i_scale);
+        
+        if (i == 0) {
+            // Small cross on the bucket under the cursor
+            ssd1306_Line(x - 1, y, x + 1, y, White);
+            ssd1306_Line(x, y - 1, x, y + 1, White);
+        } else {
+            ssd1306_DrawPixel(x, y, White);
+        }
+    }
+}
+
+/**
+  * @brief  Display graphics curve
+  * @note   The view shows GRAPH_DATA_POINTS buckets of the current zoom level,
+  *         ending at the cursor (graph_pan_offset buckets before the newest one)
+  */
+void Display_Graphics(void)
+{
+    char title_str[21] = {0};
+    Format_Buffer_t out;
+    const History_Sample_t* cursor = History_Get(graph_zoom_level, graph_pan_offset);
+    uint8_t cursor_mode = (graph_zoom_level != 0 || graph_pan_offset != 0) && cursor != NULL;
+    uint32_t age_s = 0;
+    
+    // Clear screen
+    ssd1306_Fill(Black);
+    
+    if (cursor_mode) {
+        age_s = History_Get_Age_Ms(graph_zoom_level, graph_pan_offset, HAL_GetTick()) / 1000;
+    }
+    
+    Format_Begin(&out, title_str, sizeof(title_str));
+    if (graphics_parameter >= GRAPH_MODE_OVERLAY) {
+        // Both quantities: cursor bucket when zoomed or panned, live values otherwise
+        uint16_t v = cursor_mode ? cursor->voltage : (uint16_t)(simulated_voltage * HISTORY_VOLTAGE_SCALE + 0.5f);
+        uint16_t i = cursor_mode ? cursor->current : (uint16_t)(simulated_current * HISTORY_CURRENT_SCALE + 0.5f);
+        
+        if (!cursor_mode) {
+            Format_Text(&out, (graphics_parameter == GRAPH_MODE_XY) ? "I-V " : "V+I ");
+        }
+        Graphics_Format_Value(&out, v, 0);
+        Format_Text(&out, " ");
+        Graphics_Format_Value(&out, i, 1);
+        if (cursor_mode) {
+            Graphics_Format_Cursor(&out, age_s);
+        }
+    } else if (cursor_mode) {
+        // Cursor readout: value, age and decimation factor
+        Graphics_Format_Value(&out, Graphics_Sample_Value(cursor, graphics_parameter), graphics_parameter);
+        Graphics_Format_Cursor(&out, age_s);
+    } else if (graphics_parameter == 0) {
+        Format_Text(&out, "Voltage: ");
+        Format_Fixed(&out, Format_From_Float(simulated_voltage, 1), 1, 1, 0, 0);
+        Format_Text(&out, "V");
+    } else if (graphics_parameter == 1) {
+        Format_Text(&out, "Current: ");
+        Format_Fixed(&out, Format_From_Float(simulated_current, 2), 2, 2, 0, 0);
+        Format_Text(&out, "A");
+    } else {
+        Format_Text(&out, "Power: ");
+        Format_Fixed(&out, Format_From_Float(simulated_power, 1), 1, 1, 0, 0);
+        Format_Text(&out, "W");
+    }
+    
+    // Display title
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString(title_str, Font_6x8, White);
+    
+    // Draw axes
+    ssd1306_DrawVLine(GRAPH_X_START - 1, GRAPH_Y_OFFSET, GRAPH_Y_OFFSET + GRAPH_HEIGHT - 1, White);
+    ssd1306_DrawHLine(GRAPH_X_START - 1, GRAPH_X_START + GRAPH_WIDTH - 2,
+                      GRAPH_Y_OFFSET + GRAPH_HEIGHT - 1, White);
+    
+    if (graphics_parameter == GRAPH_MODE_XY) {
+        Graphics_Plot_XY();
+    } else if (graphics_parameter == GRAPH_MODE_OVERLAY) {
+        // Voltage as a solid line on the left scale, current dotted on the right scale
+        Graphics_Plot_Trace(0, 0);
+        Graphics_Plot_Trace(1, 1);
+    } else {
+        Graphics_Plot_Trace(graphics_parameter, 0);
+    }
+    
+    // Dotted cursor line on the bucket shown in the title
+    if (cursor_mode && graphics_parameter != GRAPH_MODE_XY) {
+        for (uint8_t y = GRAPH_Y_OFFSET; y < GRAPH_Y_OFFSET + GRAPH_HEIGHT - 1; y += 2) {
+            ssd1306_DrawPixel(GRAPH_X_START + GRAPH_WIDTH, y, White);
+        }
+    }
+    
+    // Add scale labels
+    ssd1306_SetCursor(0, GRAPH_Y_OFFSET);
+    if (graphics_parameter == 0 || graphics_parameter == GRAPH_MODE_OVERLAY) {
+        ssd1306_WriteString("30", Font_6x8, White);  // Voltage
+    } else if (graphics_parameter == 1 || graphics_parameter == GRAPH_MODE_XY) {
+        ssd1306_WriteString("5", Font_6x8, White);   // Current
+    } else {
+        ssd1306_WriteString("150", Font_6x8, White); // Power
+    }
+    if (graphics_parameter == GRAPH_MODE_OVERLAY) {
+        // Current scale on the right edge
+        ssd1306_SetCursor(SSD1306_WIDTH - 6, GRAPH_Y_OFFSET);
+        ssd1306_WriteString("5", Font_6x8, White);
+    }
+    
+    ssd1306_SetCursor(0, GRAPH_Y_OFFSET + GRAPH_HEIGHT - 8);
+    ssd1306_WriteString("0", Font_6x8, White);
+}
+
+/**
+  * @brief  Display power distribution as a bar chart with percentiles
+  */
+void Display_Histogram(void)
+{
+    char title_str[22] = {0};
+    Format_Buffer_t out;
+    uint8_t bins = histogram_view_bins;
+    uint8_t bar_width = SSD1306_WIDTH / bins;
+    uint8_t chart_top = 9;
+    uint8_t chart_height = SSD1306_HEIGHT - chart_top;
+    uint32_t max_count = Histogram_Get_Max_Count(bins);
+    
+    ssd1306_Fill(Black);
+    
+    // Percentiles from the cumulative counts, upper bin edge in watts
+    Format_Begin(&out, title_str, sizeof(title_str));
+    if (Histogram_Get_Total() == 0) {
+        Format_Text(&out, "P50/95/99: no data");
+    } else {
+        Format_Text(&out, "P50:");
+        Format_Fixed(&out, Histogram_Get_Percentile(50), 1, 0, 0, 0);
+        Format_Text(&out, " 95:");
+        Format_Fixed(&out, Histogram_Get_Percentile(95), 1, 0, 0, 0);
+        Format_Text(&out, " 99:");
+        Format_Fixed(&out, Histogram_Get_Percentile(99), 1, 0, 0, 0);
+    }
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString(title_str, Font_6x8, White);
+    
+    // Bars scaled to the fullest bin, any non-empty bin shows at least one row
+    for (uint8_t bin = 0; bin < bins && max_count > 0; bin++) {
+        uint32_t count = Histogram_Get_Count(bin, bins);
+        if (count == 0) {
+            continue;
+        }
+        
+        uint8_t height = (uint8_t)((uint64_t)count * chart_height / max_count);
+        if (height == 0) height = 1;
+        
+        uint8_t x = bin * bar_width;
+        ssd1306_FillRectangle(x, SSD1306_HEIGHT - height, x + bar_width - 2, SSD1306_HEIGHT - 1, White);
+    }
+}
+
+/**
+  * @brief  Move the scope trigger level, the capture is re-armed
+  * @param  direction: 1 to raise the level, -1 to lower it
+  */
+void Scope_Adjust_Level(int8_t direction)
+{
+    Scope_Config_t config = *Scope_Get_Config();
+    
+    if (direction > 0) {
+        config.level = (config.level > SCOPE_ADC_FULL_SCALE - SCOPE_LEVEL_STEP) ?
+                       SCOPE_ADC_FULL_SCALE : config.level + SCOPE_LEVEL_STEP;
+    } else {
+        config.level = (config.level < SCOPE_LEVEL_STEP) ? 0 : config.level - SCOPE_LEVEL_STEP;
+    }
+    Scope_Set_Config(&config);
+}
+
+/**
+  * @brief  Screen row of a raw sample inside the scope area
+  */
+static uint8_t Scope_Scale_Y(uint16_t value)
+{
+    return SCOPE_Y_BOTTOM - (uint8_t)(((uint32_t)value * SCOPE_HEIGHT) / SCOPE_ADC_FULL_SCALE);
+}
+
+/**
+  * @brief  Display the triggered capture of the configured source
+  * @note   A frozen capture is centred on the trigger sample, otherwise the
+  *         live ring scrolls with the newest sample on the right
+  */
+void Display_Scope(void)
+{
+    static const char* state_names[] = {"STOP", "ARM", "TRIG", "HOLD"};
+    const Scope_Config_t* config = Scope_Get_Config();
+    Scope_State_t state = Scope_Get_State();
+    uint8_t step = 1 << scope_zoom_level;           // Pixels per sample
+    uint16_t visible = SSD1306_WIDTH / step;         // Samples on screen
+    uint16_t first = SCOPE_DEPTH - visible;          // Oldest sample shown
+    uint8_t parameter = (config->source == SCOPE_SOURCE_VOLTAGE) ? 0 : 1;
+    uint8_t level_y = Scope_Scale_Y(config->level);
+    uint16_t level_value;
+    char title[22];
+    Format_Buffer_t out;
+    
+    if (state == SCOPE_DONE) {
+        first = (config->pretrigger > visible / 2) ? config->pretrigger - visible / 2 : 0;
+        if (first > SCOPE_DEPTH - visible) first = SCOPE_DEPTH - visible;
+    }
+    
+    // Trigger level in the history units so the graph formatter can be reused
+    if (parameter == 0) {
+        level_value = (uint16_t)(Convert_ADC_to_Voltage(config->level) * HISTORY_VOLTAGE_SCALE + 0.5f);
+    } else {
+        level_value = (uint16_t)(Convert_ADC_to_Current(config->level) * HISTORY_CURRENT_SCALE + 0.5f);
+    }
+    
+    ssd1306_Fill(Black);
+    Format_Begin(&out, title, sizeof(title));
+    Format_Char(&out, (parameter == 0) ? 'V' : 'I');
+    Format_Char(&out, (config->edge == SCOPE_EDGE_RISING) ? '^' : 'v');
+    Graphics_Format_Value(&out, level_value, parameter);
+    Format_Text(&out, " ");
+    Format_Text(&out, state_names[state]);
+    Format_Text(&out, " x");
+    Format_Int(&out, step, 0, 0);
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString(title, Font_6x8, White);
+    
+    // Dotted trigger level
+    for (uint8_t x = 0; x < SSD1306_WIDTH; x += 4) {
+        ssd1306_DrawPixel(x, level_y, White);
+    }
+    
+    // Dotted trigger position once the trigger has been seen
+    if (state == SCOPE_DONE) {
+        uint8_t trigger_x = (config->pretrigger - first) * step;
+        for (uint8_t y = SCOPE_Y_BOTTOM - SCOPE_HEIGHT; y <= SCOPE_Y_BOTTOM; y += 2) {
+            ssd1306_DrawPixel(trigger_x, y, White);
+        }
+    }
+    
+    // Waveform
+    uint8_t prev_y = Scope_Scale_Y(Scope_Get_Value(Scope_Get_Sample(first)));
+    for (uint16_t i = 1; i < visible; i++) {
+        uint8_t y = Scope_Scale_Y(Scope_Get_Value(Scope_Get_Sample(first + i)));
+        ssd1306_Line((i - 1) * step, prev_y, i * step, y, White);
+        prev_y = y;
+    }
+}
+
+/**
+  * @brief  Draw a horizontal bar meter with its label
+  * @param  y Top row of the bar (7 rows high)
+  * @param  label Single character shown left of the bar
+  * @param  value Measured value
+  * @param  full_scale Value filling the whole bar
+  */
+static void Display_Bar_Meter(uint8_t y, char* label, float value, float full_scale)
+{
+    uint8_t fill;
+    
+    if (value <= 0.0f) {
+        fill = 0;
+    } else if (value >= full_scale) {
+        fill = BAR_WIDTH - 1;
+    } else {
+        fill = (uint8_t)(value * (BAR_WIDTH - 1) / full_scale);
+    }
+    
+    ssd1306_SetCursor(BAR_X - 8, y);
+    ssd1306_WriteString(label, Font_6x8, White);
+    ssd1306_DrawRectangle(BAR_X, y, BAR_X + BAR_WIDTH, y + 6, White);
+    if (fill > 0) {
+        ssd1306_FillRectangle(BAR_X + 1, y + 1, BAR_X + fill, y + 5, White);
+    }
+}
+
+/**
+  * @brief  Display the power gauge with V/I bar meters
+  * @note   Arc, ticks and needle are drawn in integers by the display driver
+  */
+void Display_Gauge(void)
+{
+    char power_str[12];
+    Format_Buffer_t out;
+    uint16_t needle_angle;
+    
+    // Needle sweeps from the left (0 W) over the top to the right (full scale)
+    if (simulated_power <= 0.0f) {
+        needle_angle = GAUGE_LEFT_ANGLE;
+    } else if (simulated_power >= HISTOGRAM_FULL_SCALE_W) {
+        needle_angle = GAUGE_RIGHT_ANGLE;
+    } else {
+        needle_angle = GAUGE_LEFT_ANGLE -
+                       (uint16_t)(simulated_power * (GAUGE_LEFT_ANGLE - GAUGE_RIGHT_ANGLE) / HISTOGRAM_FULL_SCALE_W);
+    }
+    
+    Format_Begin(&out, power_str, sizeof(power_str));
+    Format_Text(&out, "P:");
+    Format_Fixed(&out, Format_From_Float(simulated_power, 1), 1, 1, 0, 0);
+    Format_Text(&out, "W");
+    
+    ssd1306_Fill(Black);
+    
+    // Scale and ticks
+    ssd1306_DrawArc(GAUGE_X, GAUGE_Y, GAUGE_RADIUS, GAUGE_RIGHT_ANGLE, GAUGE_LEFT_ANGLE, White);
+    for (uint8_t i = 0; i <= GAUGE_TICKS; i++) {
+        ssd1306_DrawRadiusLine(GAUGE_X, GAUGE_Y, GAUGE_RADIUS - 4, GAUGE_RADIUS, 
+                               GAUGE_RIGHT_ANGLE + i * (GAUGE_LEFT_ANGLE - GAUGE_RIGHT_ANGLE) / GAUGE_TICKS, White);
+    }
+    
+    // Needle
+    ssd1306_DrawRadiusLine(GAUGE_X, GAUGE_Y, 0, GAUGE_RADIUS - 6, needle_angle, White);
+    ssd1306_FillCircle(GAUGE_X, GAUGE_Y, 2, White);
+    
+    // Readout and bar meters
+    ssd1306_SetCursor(BAR_X - 8, 0);
+    ssd1306_WriteString(power_str, Font_7x10, White);
+    Display_Bar_Meter(13, "V", simulated_voltage, 30.0f);
+    Display_Bar_Meter(24, "I", simulated_current, 5.0f);
+}
+
+/**
+  * @brief  Clear the screen when a text view is entered
+  * @retval Screen whose fields are shown by the current view
+  */
+static const Text_Screen_t* Power_Meter_Enter_View(void)
+{
+    const Text_Screen_t* screen = (power_meter_view == POWER_VIEW_BIG) ? &big_screen : &meter_screen;
+    
+    if (power_view_drawn != power_meter_view) {
+        ssd1306_Fill(Black);
+        Text_Screen_Invalidate(screen);
+        power_view_drawn = power_meter_view;
+        power_alarm_drawn = 0;
+    }
+    return screen;
+}
+
+/**
+  * @brief  Show the alarm icon while an input is at full scale
+  * @param  x Left column of the icon
+  * @param  y Top row of the icon
+  * @note   Drawn and erased only when the state changes, the pixels
+  *         around the bell are left to the text of the view
+  */
+static void Power_Meter_Alarm_Icon(uint8_t x, uint8_t y)
+{
+    uint8_t alarm = (simulated_voltage >= 30.0f || simulated_current >= 5.0f);
+    
+    if (alarm != power_alarm_drawn) {
+        ssd1306_DrawIcon(x, y, &Icon_Alarm, alarm ? SSD1306_ICON_SET : SSD1306_ICON_CLEAR);
+        power_alarm_drawn = alarm;
+    }
+}
+
+/**
+  * @brief  Display voltage, current and power in big digits
+  * @note   The screen is cleared only when the view is entered, afterwards
+  *         a frame costs the glyphs of the digits that changed
+  */
+void Display_Big_Numbers(void)
+{
+    const Text_Screen_t* screen = Power_Meter_Enter_View();
+    
+    // Fixed widths: 0.0-30.0 V, 0.00-5.00 A, 0.0-150.0 W
+    Text_Field_Set_Value(screen, BIG_VOLTAGE, Format_From_Float(simulated_voltage, 1));
+    Text_Field_Set_Value(screen, BIG_CURRENT, Format_From_Float(simulated_current, 2));
+    Text_Field_Set_Value(screen, BIG_POWER, Format_From_Float(simulated_power, 1));
+    Power_Meter_Alarm_Icon(SSD1306_WIDTH - Icon_Alarm.width, 20);
+}
+
+/**
+  * @brief  Display power meter data (separated from menu system)
+  */
+void Display_Power_Meter(void)
+{
+    const Text_Screen_t* screen;
+    char energy_str[TEXT_FIELD_MAX_CHARS + 1];
+    Format_Buffer_t out;
+    
+    if (power_meter_view == POWER_VIEW_GAUGE) {
+        Display_Gauge();
+        return;
+    }
+    if (power_meter_view == POWER_VIEW_BIG) {
+        Display_Big_Numbers();
+        return;
+    }
+    screen = Power_Meter_Enter_View();
+    
+    // Energy in Wh below 1 kWh, then in kWh with the decimals that fit the
+    // five cells before the unit once rounded: 9.999, 99.99, 999.9, 99999
+    Format_Begin(&out, energy_str, sizeof(energy_str));
+    if (accumulated_energy < 1.0f) {
+        Format_Int(&out, Format_From_Float(accumulated_energy * 1000.0f, 0), 6, 0);
+        Format_Text(&out, "Wh");
+    } else {
+        int32_t energy_wh = Format_From_Float(accumulated_energy, 3);
+        uint8_t decimals = 3;
+        
+        while (decimals > 0 && energy_wh >= energy_decimals_limit[decimals]) {
+            decimals--;
+        }
+        Format_Fixed(&out, energy_wh, 3, decimals, 0, 0);
+        Format_Text(&out, "kWh");
+    }
+    
+    Text_Field_Set_Value(screen, METER_VOLTAGE, Format_From_Float(simulated_voltage, 1));
+    Text_Field_Set_Value(screen, METER_CURRENT, Format_From_Float(simulated_current, 2));
+    Text_Field_Set_Value(screen, METER_POWER, Format_From_Float(simulated_power, 1));
+    Text_Field_Set(screen, METER_ENERGY, energy_str);
+    Text_Field_Set_Value(screen, METER_ROTARY, rotary_counter);
+    Text_Field_Set(screen, METER_BUTTON, button_state ? "ON" : "OFF");
+    Power_Meter_Alarm_Icon(SSD1306_WIDTH - Icon_Alarm.width, 22);
+}
@@ -3,6 +3,13 @@
 #include <stdlib.h>
 #include <string.h>  // For memcpy
 
+#ifndef SSD1306_TIMEOUT_MS
+#define SSD1306_TIMEOUT_MS 100
+#endif
+
+// Screen object
+static SSD1306_t SSD1306;
+
 #if defined(SSD1306_USE_I2C)
 
 void ssd1306_Reset(void) {
@@ -11,12 +18,23 @@ void ssd1306_Reset(void) {
 
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
+    if(HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
+}
+
+// Send a sequence of command bytes in one transaction
+void ssd1306_WriteCommands(const uint8_t* commands, size_t count) {
+    if(HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, (uint8_t*)commands, count, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
 }
 
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, HAL_MAX_DELAY);
+    if(HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
 }
 
 #elif defined(SSD1306_USE_SPI)
@@ -36,7 +54,19 @@ void ssd1306_Reset(void) {
 void ssd1306_WriteCommand(uint8_t byte) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
     HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
-    HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) &byte, 1, HAL_MAX_DELAY);
+    if(HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) &byte, 1, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
+}
+
+// Send a sequence of command bytes with one chip select
+void ssd1306_WriteCommands(const uint8_t* commands, size_t count) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
+    HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
+    if(HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) commands, count, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
@@ -44,7 +74,9 @@ void ssd1306_WriteCommand(uint8_t byte) {
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
     HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_SET); // data
-    HAL_SPI_Transmit(&SSD1306_SPI_PORT, buffer, buff_size, HAL_MAX_DELAY);
+    if(HAL_SPI_Transmit(&SSD1306_SPI_PORT, buffer, buff_size, SSD1306_TIMEOUT_MS) != HAL_OK) {
+        SSD1306.Degraded = 1;
+    }
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
@@ -56,112 +88,176 @@ void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
 // Screenbuffer
 static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
 
-// Screen object
-static SSD1306_t SSD1306;
+// Where the drawing primitives draw, the screenbuffer unless an off-screen
+// target was selected with ssd1306_SetTarget
+static const SSD1306_Target_t SSD1306_Screen = { SSD1306_Buffer, SSD1306_WIDTH, SSD1306_HEIGHT };
+static const SSD1306_Target_t* SSD1306_Target = &SSD1306_Screen;
+
+// Copy of the display RAM, what the last flushes have sent. The async
+// flush transmits from it, so drawing in SSD1306_Buffer can go on meanwhile
+static uint8_t SSD1306_SentBuffer[SSD1306_BUFFER_SIZE];
+
+// Columns written since the last flush, per page. Clean when DirtyMin > DirtyMax
+static uint8_t SSD1306_DirtyMin[SSD1306_PAGES];
+static uint8_t SSD1306_DirtyMax[SSD1306_PAGES];
+
+#if (SSD1306_CONTROLLER == SSD1306_CONTROLLER_SH1106)
+#define SSD1306_WINDOW_COMMANDS 3   // Page, column low and high nibbles
+#else
+#define SSD1306_WINDOW_COMMANDS 6   // 0x21 first last, 0x22 first last
+#endif
+
+// Bus cost of one window besides its data: the command transaction
+// (address, control byte, commands) and the data address and control byte
+#define SSD1306_WINDOW_OVERHEAD (SSD1306_WINDOW_COMMANDS + 4)
+
+// One transfer of a frame: column/page window, then the data filling it
+typedef struct {
+    uint8_t commands[SSD1306_WINDOW_COMMANDS];
+    uint8_t* data;          // Rows in the transmit buffer
+    uint16_t length;
+} SSD1306_Window_t;
+
+// Transfer plan of the frame being flushed
+static uint8_t SSD1306_SpanFirst[SSD1306_PAGES];
+static uint8_t SSD1306_SpanLast[SSD1306_PAGES];     // Page unchanged when First > Last
+static SSD1306_Window_t SSD1306_Windows[SSD1306_PAGES];
+
+#if defined(SSD1306_USE_I2C) && defined(SSD1306_USE_DMA)
+// Progress of the async flush
+static volatile uint8_t SSD1306_FrameInFlight = 0;
+static volatile uint8_t SSD1306_WindowCount;
+static volatile uint8_t SSD1306_WindowIndex;        // Window being transmitted
+static volatile uint8_t SSD1306_WindowDataPhase;    // 0 = window commands, 1 = data
+static uint32_t SSD1306_FrameStartTick;             // Start of the frame, for its timeout
+#endif
+
+/* Extend the dirty span of a page to include column x, off-screen targets have none */
+static inline void ssd1306_MarkDirty(uint8_t x, uint8_t page) {
+    if(SSD1306_Target != &SSD1306_Screen) {
+        return;
+    }
+    if(x < SSD1306_DirtyMin[page]) {
+        SSD1306_DirtyMin[page] = x;
+    }
+    if(x > SSD1306_DirtyMax[page]) {
+        SSD1306_DirtyMax[page] = x;
+    }
+}
+
+/*
+ * Describe the transfer of a rectangle of pages and columns. Page
+ * addressing controllers only take windows of a single page
+ */
+static void ssd1306_SetWindow(SSD1306_Window_t* window, uint8_t first_page, uint8_t last_page,
+                              uint8_t first_column, uint8_t last_column) {
+#if (SSD1306_CONTROLLER == SSD1306_CONTROLLER_SH1106)
+    uint8_t column = first_column + SSD1306_COLUMN_OFFSET;
+
+    window->commands[0] = 0xB0 | first_page;            // Page address
+    window->commands[1] = column & 0x0F;                // Column, low nibble
+    window->commands[2] = 0x10 | (column >> 4);         // Column, high nibble
+#else
+    window->commands[0] = 0x21;     // Column address
+    window->commands[1] = first_column + SSD1306_COLUMN_OFFSET;
+    window->commands[2] = last_column + SSD1306_COLUMN_OFFSET;
+    window->commands[3] = 0x22;     // Page address
+    window->commands[4] = first_page;
+    window->commands[5] = last_page;
+#endif
+    window->data = &SSD1306_SentBuffer[SSD1306_WIDTH * first_page + first_column];
+    window->length = (uint16_t)(last_page - first_page + 1) * (last_column - first_column + 1);
+}
+
+/* Force the next flush to send the whole buffer (display RAM content unknown) */
+void ssd1306_Invalidate(void) {
+    for(uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        SSD1306_DirtyMin[page] = 0;
+        SSD1306_DirtyMax[page] = SSD1306_WIDTH - 1;
+    }
+    SSD1306.FullRefresh = 1;
+}
 
 /* Fills the Screenbuffer with values from a given buffer of a fixed length */
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     SSD1306_Error_t ret = SSD1306_ERR;
     if (len <= SSD1306_BUFFER_SIZE) {
         memcpy(SSD1306_Buffer,buf,len);
+        // Always the screenbuffer, whatever target is selected
+        for(uint32_t i = 0; i < len; i += SSD1306_WIDTH) {
+            SSD1306_DirtyMin[i / SSD1306_WIDTH] = 0;
+            SSD1306_DirtyMax[i / SSD1306_WIDTH] = SSD1306_WIDTH - 1;
+        }
         ret = SSD1306_OK;
     }
     return ret;
 }
 
-/* Initialize the oled screen */
-void ssd1306_Init(void) {
-    // Reset OLED
-    ssd1306_Reset();
-
-    // Wait for the screen to boot
-    HAL_Delay(100);
-
-    // Init OLED
-    ssd1306_SetDisplayOn(0); //display off
-
-    ssd1306_WriteCommand(0x20); //Set Memory Addressing Mode
-    ssd1306_WriteCommand(0x00); // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
-                                // 10b,Page Addressing Mode (RESET); 11b,Invalid
-
-    ssd1306_WriteCommand(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
-
+// Power-on configuration, sent as a single command stream by ssd1306_Init
+static const uint8_t SSD1306_InitSequence[] = {
+    0xAE,       // Display off
+#if (SSD1306_CONTROLLER == SSD1306_CONTROLLER_SSD1306)
+    0x20, 0x00, // Memory addressing mode: horizontal, flushes set a column/page window
+#endif
+    0xB0,       // Page start address for page addressing mode, 0-7
 #ifdef SSD1306_MIRROR_VERT
-    ssd1306_WriteCommand(0xC0); // Mirror vertically
+    0xC0,       // Mirror vertically
 #else
-    ssd1306_WriteCommand(0xC8); //Set COM Output Scan Direction
+    0xC8,       // COM output scan direction
 #endif
-
-    ssd1306_WriteCommand(0x00); //---set low column address
-    ssd1306_WriteCommand(0x10); //---set high column address
-
-    ssd1306_WriteCommand(0x40); //--set start line address - CHECK
-
-    ssd1306_SetContrast(0xFF);
-
+    0x00,       // Low column address
+    0x10,       // High column address
+    0x40,       // Start line address
+    0x81, 0xFF, // Contrast
 #ifdef SSD1306_MIRROR_HORIZ
-    ssd1306_WriteCommand(0xA0); // Mirror horizontally
+    0xA0,       // Mirror horizontally
 #else
-    ssd1306_WriteCommand(0xA1); //--set segment re-map 0 to 127 - CHECK
+    0xA1,       // Segment re-map 0 to 127
 #endif
-
 #ifdef SSD1306_INVERSE_COLOR
-    ssd1306_WriteCommand(0xA7); //--set inverse color
+    0xA7,       // Inverse color
 #else
-    ssd1306_WriteCommand(0xA6); //--set normal color
+    0xA6,       // Normal color
 #endif
-
-// Set multiplex ratio.
 #if (SSD1306_HEIGHT == 128)
-    // Found in the Luma Python lib for SH1106.
-    ssd1306_WriteCommand(0xFF);
+    0xFF,       // Multiplex ratio, found in the Luma Python lib for SH1106
 #else
-    ssd1306_WriteCommand(0xA8); //--set multiplex ratio(1 to 64) - CHECK
+    0xA8,       // Multiplex ratio (1 to 64)
 #endif
-
-#if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x1F); //
-#elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x3F); //
-#elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x3F); // Seems to work for 128px high displays too.
+    SSD1306_MULTIPLEX,
+    0xA4,       // Output follows RAM content
+    0xD3, 0x00, // Display offset: none
+    0xD5, 0xF0, // Display clock divide ratio / oscillator frequency
+    0xD9, 0x22, // Pre-charge period
+    0xDA, SSD1306_COM_PINS, // COM pins hardware configuration
+    0xDB, 0x20, // VCOMH: 0.77xVcc
+#if (SSD1306_CONTROLLER == SSD1306_CONTROLLER_SH1106)
+    0xAD, 0x8B, // DC-DC enable
 #else
-#error "Only 32, 64, or 128 lines of height are supported!"
+    0x8D, 0x14, // Charge pump enable
 #endif
+    0xAF        // Display on
+};
 
-    ssd1306_WriteCommand(0xA4); //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
-
-    ssd1306_WriteCommand(0xD3); //-set display offset - CHECK
-    ssd1306_WriteCommand(0x00); //-not offset
-
-    ssd1306_WriteCommand(0xD5); //--set display clock divide ratio/oscillator frequency
-    ssd1306_WriteCommand(0xF0); //--set divide ratio
-
-    ssd1306_WriteCommand(0xD9); //--set pre-charge period
-    ssd1306_WriteCommand(0x22); //
+/* Initialize the oled screen, also recovers a degraded display */
+void ssd1306_Init(void) {
+    SSD1306.Degraded = 0;
 
-    ssd1306_WriteCommand(0xDA); //--set com pins hardware configuration - CHECK
-#if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x02);
-#elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x12);
-#elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x12);
-#else
-#error "Only 32, 64, or 128 lines of height are supported!"
-#endif
+    // Reset OLED
+    ssd1306_Reset();
 
-    ssd1306_WriteCommand(0xDB); //--set vcomh
-    ssd1306_WriteCommand(0x20); //0x20,0.77xVcc
+    // Wait for the screen to boot
+    HAL_Delay(100);
 
-    ssd1306_WriteCommand(0x8D); //--set DC-DC enable
-    ssd1306_WriteCommand(0x14); //
-    ssd1306_SetDisplayOn(1); //--turn on SSD1306 panel
+    // Init OLED, the whole sequence goes in one transaction
+    ssd1306_WriteCommands(SSD1306_InitSequence, sizeof(SSD1306_InitSequence));
+    SSD1306.DisplayOn = 1;
 
     // Clear screen
     ssd1306_Fill(Black);
     
-    // Flush buffer to screen
+    // Flush buffer to screen, the display RAM holds random data after reset
+    ssd1306_Invalidate();
     ssd1306_UpdateScreen();
     
     // Set default values for screen object
@@ -171,48 +267,315 @@ void ssd1306_Init(void) {
     SSD1306.Initialized = 1;
 }
 
-/* Fill the whole screen with the given color */
+/*
+ * Fill the whole target with the given color. Every page of the screen is
+ * marked dirty, the flush trims the spans back to the bytes that really changed
+ */
 void ssd1306_Fill(SSD1306_COLOR color) {
-    uint32_t i;
+    uint8_t pages = (SSD1306_Target->height + 7) / 8;
+
+    memset(SSD1306_Target->buffer, (color == Black) ? 0x00 : 0xFF, (size_t)SSD1306_Target->width * pages);
+    for(uint8_t page = 0; page < pages; page++) {
+        ssd1306_MarkDirty(0, page);
+        ssd1306_MarkDirty(SSD1306_Target->width - 1, page);
+    }
+}
+
+/*
+ * Select where the drawing primitives draw. An off-screen target holds
+ * width * ((height + 7) / 8) bytes laid out like the screenbuffer and is
+ * never flushed; NULL selects the screenbuffer again
+ */
+void ssd1306_SetTarget(const SSD1306_Target_t* target) {
+    SSD1306_Target = (target != NULL) ? target : &SSD1306_Screen;
+}
+
+/* The target the primitives currently draw in */
+const SSD1306_Target_t* ssd1306_GetTarget(void) {
+    return SSD1306_Target;
+}
+
+/* The screenbuffer as a target, to read back what the next flush sends */
+const SSD1306_Target_t* ssd1306_GetScreenTarget(void) {
+    return &SSD1306_Screen;
+}
 
-    for(i = 0; i < sizeof(SSD1306_Buffer); i++) {
-        SSD1306_Buffer[i] = (color == Black) ? 0x00 : 0xFF;
+/*
+ * Build the transfer plan of the changed part of the screenbuffer. Each
+ * page span is trimmed to the bytes that differ from what the display
+ * already shows and copied to the transmit buffer. The spans are then
+ * sent either as one full-width window covering all changed pages, which
+ * is a single data transaction, or as one window per page, whichever
+ * costs fewer bytes on the bus. Returns the number of windows
+ */
+static uint8_t ssd1306_PrepareFrame(void) {
+    uint8_t first_page = SSD1306_PAGES;
+    uint8_t last_page = 0;
+    uint32_t page_cost = 0;
+    uint8_t count = 0;
+
+    for(uint8_t i = 0; i < SSD1306_PAGES; i++) {
+        uint8_t* line = &SSD1306_Buffer[SSD1306_WIDTH*i];
+        uint8_t* sent = &SSD1306_SentBuffer[SSD1306_WIDTH*i];
+        int16_t first = SSD1306_DirtyMin[i];
+        int16_t last = SSD1306_DirtyMax[i];
+
+        // Columns drawn over with their previous value don't need to be sent
+        if(!SSD1306.FullRefresh) {
+            while(first <= last && line[first] == sent[first]) {
+                first++;
+            }
+            while(last >= first && line[last] == sent[last]) {
+                last--;
+            }
+        }
+
+        SSD1306_DirtyMin[i] = 0xFF;
+        SSD1306_DirtyMax[i] = 0;
+        SSD1306_SpanFirst[i] = 1;
+        SSD1306_SpanLast[i] = 0;
+        if(first > last) {
+            continue;
+        }
+
+        memcpy(&sent[first], &line[first], last - first + 1);
+        SSD1306_SpanFirst[i] = first;
+        SSD1306_SpanLast[i] = last;
+        if(first_page == SSD1306_PAGES) {
+            first_page = i;
+        }
+        last_page = i;
+        page_cost += SSD1306_WINDOW_OVERHEAD + (last - first + 1);
     }
+    SSD1306.FullRefresh = 0;
+
+    if(first_page == SSD1306_PAGES) {
+        return 0;
+    }
+
+    if(SSD1306_CONTROLLER == SSD1306_CONTROLLER_SSD1306 &&
+       SSD1306_WINDOW_OVERHEAD + (uint32_t)(last_page - first_page + 1) * SSD1306_WIDTH <= page_cost) {
+        // Rows of consecutive pages are contiguous in the buffer
+        ssd1306_SetWindow(&SSD1306_Windows[0], first_page, last_page, 0, SSD1306_WIDTH - 1);
+        count = 1;
+    } else {
+        for(uint8_t i = first_page; i <= last_page; i++) {
+            if(SSD1306_SpanFirst[i] <= SSD1306_SpanLast[i]) {
+                ssd1306_SetWindow(&SSD1306_Windows[count++], i, i, SSD1306_SpanFirst[i], SSD1306_SpanLast[i]);
+            }
+        }
+    }
+
+    SSD1306.LastFlushBytes = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        SSD1306.LastFlushBytes += sizeof(SSD1306_Windows[i].commands) + SSD1306_Windows[i].length;
+    }
+    return count;
 }
 
-/* Write the screenbuffer with changed to the screen */
+/* Write the changed part of the screenbuffer to the screen */
 void ssd1306_UpdateScreen(void) {
-    // Write data to each page of RAM. Number of pages
-    // depends on the screen height:
-    //
-    //  * 32px   ==  4 pages
-    //  * 64px   ==  8 pages
-    //  * 128px  ==  16 pages
-    for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
-        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
-        ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
-        ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
-        ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*i],SSD1306_WIDTH);
+    uint8_t count;
+
+#if defined(SSD1306_USE_I2C) && defined(SSD1306_USE_DMA)
+    // The bus belongs to the async flush until its frame is out
+    uint32_t start = HAL_GetTick();
+    while(SSD1306_FrameInFlight) {
+        if((HAL_GetTick() - start) > SSD1306_TIMEOUT_MS) {
+            SSD1306_FrameInFlight = 0;
+            SSD1306.Degraded = 1;
+        }
+    }
+#endif
+
+    SSD1306.LastFlushBytes = 0;
+    if(SSD1306.Degraded) {
+        return;
+    }
+
+    count = ssd1306_PrepareFrame();
+    for(uint8_t i = 0; i < count && !SSD1306.Degraded; i++) {
+        ssd1306_WriteCommands(SSD1306_Windows[i].commands, sizeof(SSD1306_Windows[i].commands));
+        ssd1306_WriteData(SSD1306_Windows[i].data, SSD1306_Windows[i].length);
+    }
+
+    // What the display shows after a failed transfer is unknown
+    if(SSD1306.Degraded) {
+        ssd1306_Invalidate();
+    }
+}
+
+/* Command and data bytes sent by the last ssd1306_UpdateScreen */
+uint32_t ssd1306_GetLastFlushBytes(void) {
+    return SSD1306.LastFlushBytes;
+}
+
+#if defined(SSD1306_USE_I2C) && defined(SSD1306_USE_DMA)
+
+/* Start the next transfer of the frame in flight, or end the frame */
+static void ssd1306_AsyncNext(void) {
+    HAL_StatusTypeDef status;
+    SSD1306_Window_t* window;
+
+    if(SSD1306_WindowIndex >= SSD1306_WindowCount) {
+        SSD1306_FrameInFlight = 0;
+        return;
+    }
+
+    window = &SSD1306_Windows[SSD1306_WindowIndex];
+    if(!SSD1306_WindowDataPhase) {
+        SSD1306_WindowDataPhase = 1;
+        status = HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1,
+                                       window->commands, sizeof(window->commands));
+    } else {
+        SSD1306_WindowDataPhase = 0;
+        SSD1306_WindowIndex++;
+        status = HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1,
+                                       window->data, window->length);
+    }
+
+    if(status != HAL_OK) {
+        ssd1306_TransferErrorCallback();
     }
 }
 
 /*
- * Draw one pixel in the screenbuffer
- * X => X Coordinate
- * Y => Y Coordinate
- * color => Pixel color
+ * Start sending the changed part of the screenbuffer without waiting.
+ * The changed spans are copied to the transmit buffer first, so drawing
+ * the next frame can start right away. Returns SSD1306_BUSY while the
+ * previous frame is in flight; its changes are then kept for the next call
  */
-void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
-    if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+SSD1306_Error_t ssd1306_UpdateScreenAsync(void) {
+    uint8_t count;
+
+    if(SSD1306_FrameInFlight) {
+        // A frame that never completes means a hung bus
+        if((HAL_GetTick() - SSD1306_FrameStartTick) > SSD1306_TIMEOUT_MS) {
+            SSD1306_FrameInFlight = 0;
+            SSD1306.Degraded = 1;
+            ssd1306_Invalidate();
+            return SSD1306_ERR;
+        }
+        SSD1306.DeferredFrames++;
+        return SSD1306_BUSY;
+    }
+
+    SSD1306.LastFlushBytes = 0;
+    if(SSD1306.Degraded) {
+        return SSD1306_ERR;
+    }
+
+    count = ssd1306_PrepareFrame();
+    if(count == 0) {
+        return SSD1306_OK;
+    }
+
+    SSD1306_WindowCount = count;
+    SSD1306_WindowIndex = 0;
+    SSD1306_WindowDataPhase = 0;
+    SSD1306_FrameStartTick = HAL_GetTick();
+    SSD1306_FrameInFlight = 1;
+    ssd1306_AsyncNext();
+    return SSD1306_OK;
+}
+
+/* Call from HAL_I2C_MemTxCpltCallback for the display I2C port */
+void ssd1306_TransferCompleteCallback(void) {
+    if(SSD1306_FrameInFlight) {
+        ssd1306_AsyncNext();
+    }
+}
+
+/* Call from HAL_I2C_ErrorCallback, the frame is dropped and resent in full after ssd1306_Init */
+void ssd1306_TransferErrorCallback(void) {
+    SSD1306_FrameInFlight = 0;
+    SSD1306.Degraded = 1;
+    ssd1306_Invalidate();
+}
+
+/* 1 while an async frame is being transmitted */
+uint8_t ssd1306_IsFrameInFlight(void) {
+    return SSD1306_FrameInFlight;
+}
+
+#else
+
+/* Without DMA the async flush is the blocking one */
+SSD1306_Error_t ssd1306_UpdateScreenAsync(void) {
+    ssd1306_UpdateScreen();
+    return SSD1306_OK;
+}
+
+void ssd1306_TransferCompleteCallback(void) {
+}
+
+void ssd1306_TransferErrorCallback(void) {
+}
+
+uint8_t ssd1306_IsFrameInFlight(void) {
+    return 0;
+}
+
+#endif
+
+/* 1 once a transfer failed or timed out, until ssd1306_Init succeeds */
+uint8_t ssd1306_IsDegraded(void) {
+    return SSD1306.Degraded;
+}
+
+/* Number of async flushes refused because a frame was in flight */
+uint32_t ssd1306_GetDeferredFrames(void) {
+    return SSD1306.DeferredFrames;
+}
+
+/*
+ * Set one pixel, inlined in the line and circle loops. Coordinates are
+ * signed so shapes running off the left or top edge are clipped here
+ */
+static inline void ssd1306_PlotPixel(int16_t x, int16_t y, SSD1306_COLOR color) {
+    if(x < 0 || y < 0 || x >= SSD1306_Target->width || y >= SSD1306_Target->height) {
         // Don't write outside the buffer
         return;
     }
    
     // Draw in the right color
+    uint8_t* byte = &SSD1306_Target->buffer[x + (y / 8) * SSD1306_Target->width];
+    uint8_t value;
     if(color == White) {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+        value = *byte | (1 << (y % 8));
     } else { 
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+        value = *byte & ~(1 << (y % 8));
+    }
+
+    if(value != *byte) {
+        *byte = value;
+        ssd1306_MarkDirty(x, y / 8);
+    }
+}
+
+/*
+ * Draw one pixel in the screenbuffer
+ * X => X Coordinate
+ * Y => Y Coordinate
+ * color => Pixel color
+ */
+void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
+    ssd1306_PlotPixel(x, y, color);
+}
+
+/*
+ * Merge bits into one byte of the target
+ * index => Byte of the buffer, in page x
+ * mask  => Bits to replace
+ * bits  => New value of the masked bits
+ */
+static inline void ssd1306_BlitByte(uint16_t index, uint8_t x, uint8_t page, uint8_t mask, uint8_t bits) {
+    uint8_t* buffer = SSD1306_Target->buffer;
+    uint8_t value = (buffer[index] & ~mask) | bits;
+
+    if(value != buffer[index]) {
+        buffer[index] = value;
+        ssd1306_MarkDirty(x, page);
     }
 }
 
@@ -221,30 +584,53 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
  * ch       => char om weg te schrijven
  * Font     => Font waarmee we gaan schrijven
  * color    => Black or White
+ *
+ * Glyph bytes are copied a column at a time, shifted down to the cursor
+ * row; a byte straddling two pages is split between them. Background
+ * pixels are written too, in the opposite color
  */
 char ssd1306_WriteChar(char ch, FontDef Font, SSD1306_COLOR color) {
-    uint32_t i, b, j;
+    uint8_t pages = (Font.FontHeight + 7) / 8;
+    uint8_t page = SSD1306.CurrentY / 8;
+    uint8_t shift = SSD1306.CurrentY % 8;
+    uint8_t x = SSD1306.CurrentX;
+    const uint8_t* glyph;
+    uint8_t invert = (color == White) ? 0x00 : 0xFF;
+    uint8_t index;
     
     // Check if character is valid
     if (ch < 32 || ch > 126)
         return 0;
     
+    // Subset fonts only hold some characters
+    index = ch - 32;
+    if (Font.map != NULL) {
+        index = Font.map[index];
+        if (index == SSD1306_GLYPH_MISSING)
+            return 0;
+    }
+    
     // Check remaining space on current line
-    if (SSD1306_WIDTH < (SSD1306.CurrentX + Font.FontWidth) ||
-        SSD1306_HEIGHT < (SSD1306.CurrentY + Font.FontHeight))
+    if (SSD1306_Target->width < (SSD1306.CurrentX + Font.FontWidth) ||
+        SSD1306_Target->height < (SSD1306.CurrentY + Font.FontHeight))
     {
         // Not enough space on current line
         return 0;
     }
     
     // Use the font to write
-    for(i = 0; i < Font.FontHeight; i++) {
-        b = Font.data[(ch - 32) * Font.FontHeight + i];
-        for(j = 0; j < Font.FontWidth; j++) {
-            if((b << j) & 0x8000)  {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR) color);
-            } else {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR)!color);
+    glyph = &Font.data[index * Font.FontWidth * pages];
+    for(uint8_t i = 0; i < pages; i++, page++) {
+        uint8_t rows = Font.FontHeight - i * 8;
+        uint16_t mask = (uint16_t)((rows >= 8) ? 0xFF : (1 << rows) - 1) << shift;
+        uint16_t offset = page * SSD1306_Target->width + x;
+
+        for(uint8_t j = 0; j < Font.FontWidth; j++, offset++) {
+            uint16_t bits = ((uint16_t)(*glyph++ ^ invert) << shift) & mask;
+
+            ssd1306_BlitByte(offset, x + j, page, (uint8_t)mask, (uint8_t)bits);
+            if(mask > 0xFF) {
+                ssd1306_BlitByte(offset + SSD1306_Target->width, x + j, page + 1, mask >> 8, bits >> 8);
             }
         }
     }
@@ -278,6 +664,16 @@ void ssd1306_SetCursor(uint8_t x, uint8_t y) {
 
 /* Draw line by Bresenhem's algorithm */
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    // Axis-aligned lines are spans of whole bytes
+    if(y1 == y2) {
+        ssd1306_DrawHLine(x1, x2, y1, color);
+        return;
+    }
+    if(x1 == x2) {
+        ssd1306_DrawVLine(x1, y1, y2, color);
+        return;
+    }
+
     int32_t deltaX = abs(x2 - x1);
     int32_t deltaY = abs(y2 - y1);
     int32_t signX = ((x1 < x2) ? 1 : -1);
@@ -285,10 +681,10 @@ void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR
     int32_t error = deltaX - deltaY;
     int32_t error2;
     
-    ssd1306_DrawPixel(x2, y2, color);
+    ssd1306_PlotPixel(x2, y2, color);
 
     while((x1 != x2) || (y1 != y2)) {
-        ssd1306_DrawPixel(x1, y1, color);
+        ssd1306_PlotPixel(x1, y1, color);
         error2 = error * 2;
         if(error2 > -deltaY) {
             error -= deltaY;
@@ -338,8 +734,9 @@ static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg) {
  * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
  * start_angle in degree
  * sweep in degree
+ * Floating point version, kept as a reference for ssd1306_DrawArc
  */
-void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
+void ssd1306_DrawArcFloat(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
     float approx_degree;
     uint32_t approx_segments;
@@ -378,8 +775,9 @@ void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle,
  * Angle is beginning from 4 quart of trigonometric circle (3pi/2)
  * start_angle: start angle in degree
  * sweep: finish angle in degree
+ * Floating point version, kept as a reference for ssd1306_DrawArcWithRadiusLine
  */
-void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
+void ssd1306_DrawArcWithRadiusLineFloat(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
     float approx_degree;
     uint32_t approx_segments;
@@ -421,108 +819,382 @@ void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_
     return;
 }
 
-/* Draw circle by Bresenhem's algorithm */
-void ssd1306_DrawCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
-    int32_t x = -par_r;
-    int32_t y = 0;
-    int32_t err = 2 - 2 * par_r;
-    int32_t e2;
+/* Sine of 0..90 degrees in Q15, the other quadrants are mirrored from it */
+static const uint16_t ssd1306_SinTable[91] = {
+        0,   572,  1144,  1715,  2286,  2856,  3425,  3993,  4560,  5126,
+     5690,  6252,  6813,  7371,  7927,  8481,  9032,  9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886,
+    16384, 16877, 17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622,
+    21063, 21498, 21926, 22348, 22763, 23170, 23571, 23965, 24351, 24730,
+    25102, 25466, 25822, 26170, 26510, 26842, 27166, 27482, 27789, 28088,
+    28378, 28660, 28932, 29197, 29452, 29698, 29935, 30163, 30382, 30592,
+    30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166,
+    32270, 32365, 32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763,
+    32768
+};
+
+/* Sine of an angle in degree, Q15 (32768 = 1.0) */
+int32_t ssd1306_Sin(uint16_t par_deg) {
+    par_deg %= 360;
+    if(par_deg <= 90) {
+        return ssd1306_SinTable[par_deg];
+    } else if(par_deg <= 180) {
+        return ssd1306_SinTable[180 - par_deg];
+    } else if(par_deg <= 270) {
+        return -(int32_t)ssd1306_SinTable[par_deg - 180];
+    }
+    return -(int32_t)ssd1306_SinTable[360 - par_deg];
+}
 
-    if (par_x >= SSD1306_WIDTH || par_y >= SSD1306_HEIGHT) {
-        return;
+/* Cosine of an angle in degree, Q15 (32768 = 1.0) */
+int32_t ssd1306_Cos(uint16_t par_deg) {
+    return ssd1306_Sin((par_deg % 360) + 90);
+}
+
+/* Point of a circle, truncated toward the centre like the float version */
+static void ssd1306_ArcPoint(uint8_t x, uint8_t y, uint8_t radius, uint16_t par_deg, uint8_t *px, uint8_t *py) {
+    *px = x + (int8_t)((ssd1306_Sin(par_deg) * radius) / 32768);
+    *py = y + (int8_t)((ssd1306_Cos(par_deg) * radius) / 32768);
+}
+
+/*
+ * Angles of an arc, in the ssd1306_DrawArc convention. Octant k covers
+ * 45k..45k+45 degrees; octants inside the arc are drawn whole, octants
+ * crossing one of its ends test each pixel against the end directions
+ */
+typedef struct {
+    int32_t start_sin, start_cos;   // Q15 direction of the first angle
+    int32_t end_sin, end_cos;       // Q15 direction of the last angle
+    uint16_t span;                  // Degrees, 1..360
+    uint8_t whole;                  // Octants entirely inside the arc
+    uint8_t partial;                // Octants holding one end of the arc
+} SSD1306_Arc_t;
+
+static uint8_t ssd1306_ArcInit(SSD1306_Arc_t* arc, uint16_t start_angle, uint16_t end_angle) {
+    uint16_t first = start_angle % 360;
+    uint16_t last;
+
+    // Nothing to draw when the end does not come after the start, like the segment version
+    if(end_angle <= start_angle) {
+        return 0;
+    }
+    arc->span = (end_angle - start_angle >= 360) ? 360 : end_angle - start_angle;
+    last = first + arc->span;
+
+    arc->start_sin = ssd1306_Sin(first);
+    arc->start_cos = ssd1306_Cos(first);
+    arc->end_sin = ssd1306_Sin(last);
+    arc->end_cos = ssd1306_Cos(last);
+    arc->whole = 0;
+    arc->partial = 0;
+
+    for(uint8_t k = 0; k < 8; k++) {
+        uint16_t low = k * 45;
+        uint16_t high = low + 45;
+
+        if((low >= first && high <= last) || (low + 360 >= first && high + 360 <= last)) {
+            arc->whole |= 1 << k;
+        } else if((high >= first && low <= last) || (high + 360 >= first && low + 360 <= last)) {
+            arc->partial |= 1 << k;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Offset from the centre lies between the arc ends. The cross products
+ * with the end directions are the sines of the angles to them
+ */
+static uint8_t ssd1306_ArcContains(const SSD1306_Arc_t* arc, int16_t dx, int16_t dy) {
+    int32_t after_start = dx * arc->start_cos - dy * arc->start_sin;
+    int32_t before_end = dy * arc->end_sin - dx * arc->end_cos;
+
+    if(arc->span <= 180) {
+        return after_start >= 0 && before_end >= 0;
     }
+    return after_start >= 0 || before_end >= 0;
+}
 
-    do {
-        ssd1306_DrawPixel(par_x - x, par_y + y, par_color);
-        ssd1306_DrawPixel(par_x + x, par_y + y, par_color);
-        ssd1306_DrawPixel(par_x + x, par_y - y, par_color);
-        ssd1306_DrawPixel(par_x - x, par_y - y, par_color);
-        e2 = err;
+/* Plot the point of an octant if it belongs to the arc */
+static inline void ssd1306_ArcPixel(const SSD1306_Arc_t* arc, uint8_t octant, uint8_t x, uint8_t y,
+                                    int16_t dx, int16_t dy, SSD1306_COLOR color) {
+    if((arc->whole & (1 << octant)) ||
+       ((arc->partial & (1 << octant)) && ssd1306_ArcContains(arc, dx, dy))) {
+        ssd1306_PlotPixel(x + dx, y + dy, color);
+    }
+}
 
-        if (e2 <= y) {
-            y++;
-            err = err + (y * 2 + 1);
-            if(-x == y && e2 <= x) {
-                e2 = 0;
+/*
+ * Midpoint circle, walked over the first octant with x going from 0 to
+ * y and mirrored to the seven others. The point on the diagonal is left
+ * out after a straight step, where its neighbours already meet; this
+ * gives the same pixels as the Bresenham circle drawn before. A NULL arc
+ * draws the whole circle
+ */
+static void ssd1306_RasterCircle(uint8_t par_x, uint8_t par_y, uint8_t par_r, const SSD1306_Arc_t* arc,
+                                 SSD1306_COLOR color) {
+    int16_t x = 0;
+    int16_t y = par_r;
+    int16_t d = 1 - par_r;
+    uint8_t diagonal = 1;
+
+    while(x <= y) {
+        if(x < y || diagonal) {
+            if(arc == NULL) {
+                ssd1306_PlotPixel(par_x + x, par_y + y, color);
+                ssd1306_PlotPixel(par_x + y, par_y + x, color);
+                ssd1306_PlotPixel(par_x + y, par_y - x, color);
+                ssd1306_PlotPixel(par_x + x, par_y - y, color);
+                ssd1306_PlotPixel(par_x - x, par_y - y, color);
+                ssd1306_PlotPixel(par_x - y, par_y - x, color);
+                ssd1306_PlotPixel(par_x - y, par_y + x, color);
+                ssd1306_PlotPixel(par_x - x, par_y + y, color);
+            } else {
+                ssd1306_ArcPixel(arc, 0, par_x, par_y, x, y, color);
+                ssd1306_ArcPixel(arc, 1, par_x, par_y, y, x, color);
+                ssd1306_ArcPixel(arc, 2, par_x, par_y, y, -x, color);
+                ssd1306_ArcPixel(arc, 3, par_x, par_y, x, -y, color);
+                ssd1306_ArcPixel(arc, 4, par_x, par_y, -x, -y, color);
+                ssd1306_ArcPixel(arc, 5, par_x, par_y, -y, -x, color);
+                ssd1306_ArcPixel(arc, 6, par_x, par_y, -y, x, color);
+                ssd1306_ArcPixel(arc, 7, par_x, par_y, -x, y, color);
             }
         }
 
-        if (e2 > x) {
-            x++;
-            err = err + (x * 2 + 1);
+        if(d < 0) {
+            d += 2 * x + 3;
+            diagonal = 0;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+            diagonal = 1;
         }
-    } while (x <= 0);
+        x++;
+    }
+}
 
+/*
+ * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
+ * start_angle in degree
+ * sweep: finish angle in degree
+ * The pixels of the midpoint circle between both angles, in integers only
+ */
+void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
+#ifdef SSD1306_USE_FLOAT_TRIG
+    ssd1306_DrawArcFloat(x, y, radius, start_angle, sweep, color);
+#else
+    SSD1306_Arc_t arc;
+
+    if(ssd1306_ArcInit(&arc, start_angle, sweep)) {
+        ssd1306_RasterCircle(x, y, radius, &arc, color);
+    }
+#endif
     return;
 }
 
-/* Draw filled circle. Pixel positions calculated using Bresenham's algorithm */
-void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
-    int32_t x = -par_r;
-    int32_t y = 0;
-    int32_t err = 2 - 2 * par_r;
-    int32_t e2;
+/*
+ * Draw arc with radius line
+ * Angle is beginning from 4 quart of trigonometric circle (3pi/2)
+ * start_angle: start angle in degree
+ * sweep: finish angle in degree
+ * The pixels of the midpoint circle between both angles, in integers only
+ */
+void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
+#ifdef SSD1306_USE_FLOAT_TRIG
+    ssd1306_DrawArcWithRadiusLineFloat(x, y, radius, start_angle, sweep, color);
+#else
+    SSD1306_Arc_t arc;
 
-    if (par_x >= SSD1306_WIDTH || par_y >= SSD1306_HEIGHT) {
+    if(!ssd1306_ArcInit(&arc, start_angle, sweep)) {
         return;
     }
+    ssd1306_RasterCircle(x, y, radius, &arc, color);
 
-    do {
-        for (uint8_t _y = (par_y + y); _y >= (par_y - y); _y--) {
-            for (uint8_t _x = (par_x - x); _x >= (par_x + x); _x--) {
-                ssd1306_DrawPixel(_x, _y, par_color);
-            }
-        }
+    // Radius lines
+    ssd1306_DrawRadiusLine(x, y, 0, radius, start_angle, color);
+    ssd1306_DrawRadiusLine(x, y, 0, radius, start_angle + arc.span, color);
+#endif
+    return;
+}
 
-        e2 = err;
-        if (e2 <= y) {
-            y++;
-            err = err + (y * 2 + 1);
-            if (-x == y && e2 <= x) {
-                e2 = 0;
-            }
+/*
+ * Draw a radial segment between two distances from the centre, for gauge
+ * needles and ticks. Angle uses the same origin as ssd1306_DrawArc
+ */
+void ssd1306_DrawRadiusLine(uint8_t x, uint8_t y, uint8_t inner_radius, uint8_t outer_radius, uint16_t angle, SSD1306_COLOR color) {
+    uint8_t xp1, yp1, xp2, yp2;
+
+    ssd1306_ArcPoint(x, y, inner_radius, angle, &xp1, &yp1);
+    ssd1306_ArcPoint(x, y, outer_radius, angle, &xp2, &yp2);
+    ssd1306_Line(xp1, yp1, xp2, yp2, color);
+    return;
+}
+
+/* Draw circle, midpoint algorithm with eight-way symmetry */
+void ssd1306_DrawCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
+    if (par_x >= SSD1306_Target->width || par_y >= SSD1306_Target->height) {
+        return;
+    }
+
+    ssd1306_RasterCircle(par_x, par_y, par_r, NULL, par_color);
+    return;
+}
+
+/* Column pair of a filled circle, clipped to the target */
+static void ssd1306_FillCircleColumns(uint8_t par_x, uint8_t par_y, int16_t dx, int16_t half_height,
+                                      SSD1306_COLOR par_color) {
+    int16_t top = par_y - half_height;
+    int16_t bottom = par_y + half_height;
+
+    if (top < 0) {
+        top = 0;
+    }
+    if (bottom >= SSD1306_Target->height) {
+        bottom = SSD1306_Target->height - 1;
+    }
+    if (par_x + dx < SSD1306_Target->width) {
+        ssd1306_FillRectangle(par_x + dx, top, par_x + dx, bottom, par_color);
+    }
+    if (dx != 0 && par_x - dx >= 0) {
+        ssd1306_FillRectangle(par_x - dx, top, par_x - dx, bottom, par_color);
+    }
+}
+
+/*
+ * Draw filled circle as one vertical span per column, a few masked bytes
+ * each. The midpoint walk of ssd1306_DrawCircle gives the height of
+ * column x on its first step, and of column y on its last step before y
+ * moves or the walk ends
+ */
+void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
+    int16_t x = 0;
+    int16_t y = par_r;
+    int16_t d = 1 - par_r;
+    int16_t tallest = 0;
+    uint8_t diagonal = 1;
+
+    if (par_x >= SSD1306_Target->width || par_y >= SSD1306_Target->height) {
+        return;
+    }
+
+    while (x <= y) {
+        // The diagonal point left out by ssd1306_DrawCircle is not filled either
+        if (x < y || diagonal) {
+            ssd1306_FillCircleColumns(par_x, par_y, x, y, par_color);
+            tallest = x;
         }
 
-        if (e2 > x) {
-            x++;
-            err = err + (x * 2 + 1);
+        if (d < 0) {
+            d += 2 * x + 3;
+            diagonal = 0;
+        } else {
+            ssd1306_FillCircleColumns(par_x, par_y, y, tallest, par_color);
+            d += 2 * (x - y) + 5;
+            y--;
+            diagonal = 1;
         }
-    } while (x <= 0);
+        x++;
+    }
+    if (!diagonal) {
+        ssd1306_FillCircleColumns(par_x, par_y, y, tallest, par_color);
+    }
 
     return;
 }
 
 /* Draw a rectangle */
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
-    ssd1306_Line(x1,y1,x2,y1,color);
-    ssd1306_Line(x2,y1,x2,y2,color);
-    ssd1306_Line(x2,y2,x1,y2,color);
-    ssd1306_Line(x1,y2,x1,y1,color);
+    ssd1306_DrawHLine(x1,x2,y1,color);
+    ssd1306_DrawVLine(x2,y1,y2,color);
+    ssd1306_DrawHLine(x1,x2,y2,color);
+    ssd1306_DrawVLine(x1,y1,y2,color);
 
     return;
 }
 
-/* Draw a filled rectangle */
+/*
+ * Set or clear the mask bits of the bytes x1..x2 of one page, and extend
+ * the dirty span once over the bytes that changed
+ */
+static void ssd1306_FillSpan(uint8_t page, uint8_t x1, uint8_t x2, uint8_t mask, SSD1306_COLOR color) {
+    uint8_t* byte = &SSD1306_Target->buffer[page * SSD1306_Target->width + x1];
+    uint8_t set = (color == White) ? mask : 0x00;
+    uint8_t changed = 0;
+    uint8_t first = 0;
+    uint8_t last = 0;
+
+    for(uint8_t x = x1; x <= x2; x++, byte++) {
+        uint8_t value = (*byte & ~mask) | set;
+
+        if(value != *byte) {
+            *byte = value;
+            if(!changed) {
+                first = x;
+                changed = 1;
+            }
+            last = x;
+        }
+    }
+
+    if(changed) {
+        ssd1306_MarkDirty(first, page);
+        ssd1306_MarkDirty(last, page);
+    }
+}
+
+/* Draw a filled rectangle, one masked byte span per page */
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
     uint8_t x_start = ((x1<=x2) ? x1 : x2);
     uint8_t x_end   = ((x1<=x2) ? x2 : x1);
     uint8_t y_start = ((y1<=y2) ? y1 : y2);
     uint8_t y_end   = ((y1<=y2) ? y2 : y1);
 
-    for (uint8_t y= y_start; (y<= y_end)&&(y<SSD1306_HEIGHT); y++) {
-        for (uint8_t x= x_start; (x<= x_end)&&(x<SSD1306_WIDTH); x++) {
-            ssd1306_DrawPixel(x, y, color);
+    if (x_start >= SSD1306_Target->width || y_start >= SSD1306_Target->height) {
+        return;
+    }
+    if (x_end >= SSD1306_Target->width) {
+        x_end = SSD1306_Target->width - 1;
+    }
+    if (y_end >= SSD1306_Target->height) {
+        y_end = SSD1306_Target->height - 1;
+    }
+
+    for (uint8_t page = y_start / 8; page <= y_end / 8; page++) {
+        uint8_t mask = 0xFF;
+
+        // The first and last pages are only partly covered
+        if (page == y_start / 8) {
+            mask &= 0xFF << (y_start % 8);
+        }
+        if (page == y_end / 8) {
+            mask &= 0xFF >> (7 - y_end % 8);
         }
+        ssd1306_FillSpan(page, x_start, x_end, mask, color);
     }
     return;
 }
 
+/* Draw a horizontal line */
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color) {
+    ssd1306_FillRectangle(x1, y, x2, y, color);
+}
+
+/* Draw a vertical line, one byte per page */
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    ssd1306_FillRectangle(x, y1, x, y2, color);
+}
+
+/* Clear a rectangle of the screenbuffer */
+void ssd1306_ClearRegion(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    ssd1306_FillRectangle(x1, y1, x2, y2, Black);
+}
+
 /* Draw a bitmap */
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color) {
     int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
     uint8_t byte = 0;
 
-    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+    if (x >= SSD1306_Target->width || y >= SSD1306_Target->height) {
         return;
     }
 
@@ -542,10 +1214,123 @@ void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8
     return;
 }
 
+/*
+ * Copy an off-screen target into the current target at x, y, both colors.
+ * Source bytes are shifted to the destination row like glyphs, and the
+ * parts falling outside the current target are clipped
+ */
+void ssd1306_BlitTarget(const SSD1306_Target_t* source, uint8_t x, uint8_t y) {
+    uint8_t pages = (SSD1306_Target->height + 7) / 8;
+    uint8_t page = y / 8;
+    uint8_t shift = y % 8;
+    uint8_t width;
+
+    if (source == NULL || source == SSD1306_Target || x >= SSD1306_Target->width || y >= SSD1306_Target->height) {
+        return;
+    }
+    width = (source->width < SSD1306_Target->width - x) ? source->width : SSD1306_Target->width - x;
+
+    for (uint8_t i = 0; i * 8 < source->height && page < pages; i++, page++) {
+        uint8_t rows = source->height - i * 8;
+        uint16_t mask = (uint16_t)((rows >= 8) ? 0xFF : (1 << rows) - 1) << shift;
+        const uint8_t* column = &source->buffer[i * source->width];
+        uint16_t index = page * SSD1306_Target->width + x;
+
+        for (uint8_t j = 0; j < width; j++, index++) {
+            uint16_t bits = ((uint16_t)column[j] << shift) & mask;
+
+            ssd1306_BlitByte(index, x + j, page, (uint8_t)mask, (uint8_t)bits);
+            if (mask > 0xFF && page + 1 < pages) {
+                ssd1306_BlitByte(index + SSD1306_Target->width, x + j, page + 1, mask >> 8, bits >> 8);
+            }
+        }
+    }
+}
+
+/* Next byte of icon data, decoding the runs of an RLE icon */
+typedef struct {
+    const uint8_t* data;
+    uint8_t rle;
+    uint8_t count;      // Bytes left in the current run or literal block
+    uint8_t repeat;     // The block is a run of value
+    uint8_t value;
+} SSD1306_IconReader_t;
+
+static inline uint8_t ssd1306_IconNext(SSD1306_IconReader_t* reader) {
+    if (!reader->rle) {
+        return *reader->data++;
+    }
+    if (reader->count == 0) {
+        uint8_t control = *reader->data++;
+
+        reader->count = (control & 0x7F) + 1;
+        reader->repeat = control & 0x80;
+        if (reader->repeat) {
+            reader->value = *reader->data++;
+        }
+    }
+    reader->count--;
+    return reader->repeat ? reader->value : *reader->data++;
+}
+
+/*
+ * Draw an icon of an atlas at x, y. Its column bytes are shifted to the
+ * row and merged a byte at a time like glyphs, and the parts outside the
+ * current target are clipped.
+ * RLE data is a series of blocks: a control byte 0x80 | (n - 1) followed
+ * by one byte repeated n times, or n - 1 followed by n literal bytes
+ */
+void ssd1306_DrawIcon(uint8_t x, uint8_t y, const SSD1306_Icon_t* icon, SSD1306_IconMode_t mode) {
+    uint8_t pages = (SSD1306_Target->height + 7) / 8;
+    uint8_t page = y / 8;
+    uint8_t shift = y % 8;
+    SSD1306_IconReader_t reader = { icon->data, icon->rle, 0, 0, 0 };
+
+    if (x >= SSD1306_Target->width || y >= SSD1306_Target->height) {
+        return;
+    }
+
+    // Every byte is read, the encoded stream cannot skip the clipped ones
+    for (uint8_t i = 0; i * 8 < icon->height; i++, page++) {
+        uint8_t rows = icon->height - i * 8;
+        uint16_t mask = (uint16_t)((rows >= 8) ? 0xFF : (1 << rows) - 1) << shift;
+        uint16_t index = page * SSD1306_Target->width + x;
+
+        for (uint8_t j = 0; j < icon->width; j++, index++) {
+            uint16_t bits = ((uint16_t)ssd1306_IconNext(&reader) << shift) & mask;
+            uint16_t merge_mask = mask;
+            uint16_t merge_bits = bits;
+
+            if (page >= pages || x + j >= SSD1306_Target->width) {
+                continue;
+            }
+            if (mode == SSD1306_ICON_SET) {
+                merge_mask = bits;
+            } else if (mode == SSD1306_ICON_CLEAR) {
+                merge_mask = bits;
+                merge_bits = 0;
+            } else if (mode == SSD1306_ICON_XOR) {
+                uint16_t current = SSD1306_Target->buffer[index];
+
+                if (mask > 0xFF && page + 1 < pages) {
+                    current |= (uint16_t)SSD1306_Target->buffer[index + SSD1306_Target->width] << 8;
+                }
+                merge_mask = bits;
+                merge_bits = ~current & bits;
+            }
+
+            ssd1306_BlitByte(index, x + j, page, (uint8_t)merge_mask, (uint8_t)merge_bits);
+            if (mask > 0xFF && page + 1 < pages) {
+                ssd1306_BlitByte(index + SSD1306_Target->width, x + j, page + 1, merge_mask >> 8, merge_bits >> 8);
+            }
+        }
+    }
+}
+
 void ssd1306_SetContrast(const uint8_t value) {
     const uint8_t kSetContrastControlRegister = 0x81;
-    ssd1306_WriteCommand(kSetContrastControlRegister);
-    ssd1306_WriteCommand(value);
+    uint8_t commands[2] = { kSetContrastControlRegister, value };
+    ssd1306_WriteCommands(commands, sizeof(commands));
 }
 
 void ssd1306_SetDisplayOn(const uint8_t on) {
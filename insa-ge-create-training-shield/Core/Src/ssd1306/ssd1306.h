@@ -9,13 +9,21 @@
 #define __SSD1306_H__
 
 #include <stddef.h>
+#if defined(SSD1306_HOST)
+/* Host build of the drawing code, see Tools/ssd1306_host */
+#include "ssd1306_host.h"
+#else
 #include <_ansi.h>
+#endif
 
 _BEGIN_STD_C
 
 #include "ssd1306_conf.h"
+#include "ssd1306_panels.h"
 
-#if defined(STM32F0)
+#if defined(SSD1306_HOST)
+/* HAL declarations come from ssd1306_host.h */
+#elif defined(STM32F0)
 #include "stm32f0xx_hal.h"
 #elif defined(STM32F1)
 #include "stm32f1xx_hal.h"
@@ -42,13 +50,9 @@ _BEGIN_STD_C
 #error "SSD1306 library was tested only on STM32F0, STM32F1, STM32F3, STM32F4, STM32F7, STM32L0, STM32L1, STM32L4, STM32H7, STM32G0, STM32G4 MCU families. Please modify ssd1306.h if you know what you are doing. Also please send a pull request if it turns out the library works on other MCU's as well!"
 #endif
 
-#ifdef SSD1306_X_OFFSET
-#define SSD1306_X_OFFSET_LOWER (SSD1306_X_OFFSET & 0x0F)
-#define SSD1306_X_OFFSET_UPPER ((SSD1306_X_OFFSET >> 4) & 0x07)
-#else
-#define SSD1306_X_OFFSET_LOWER 0
-#define SSD1306_X_OFFSET_UPPER 0
-#endif
+// First RAM column shown by the panel, see ssd1306_panels.h
+#define SSD1306_X_OFFSET_LOWER (SSD1306_COLUMN_OFFSET & 0x0F)
+#define SSD1306_X_OFFSET_UPPER ((SSD1306_COLUMN_OFFSET >> 4) & 0x07)
 
 #include "ssd1306_fonts.h"
 
@@ -101,15 +105,10 @@ extern SPI_HandleTypeDef SSD1306_SPI_PORT;
 #error "You should define SSD1306_USE_SPI or SSD1306_USE_I2C macro!"
 #endif
 
-// SSD1306 OLED height in pixels
-#ifndef SSD1306_HEIGHT
-#define SSD1306_HEIGHT          64
-#endif
+// SSD1306_WIDTH and SSD1306_HEIGHT come from the panel, see ssd1306_panels.h
 
-// SSD1306 width in pixels
-#ifndef SSD1306_WIDTH
-#define SSD1306_WIDTH           128
-#endif
+// Number of 8-pixel rows (pages) of the display RAM
+#define SSD1306_PAGES           (SSD1306_HEIGHT / 8)
 
 #ifndef SSD1306_BUFFER_SIZE
 #define SSD1306_BUFFER_SIZE   SSD1306_WIDTH * SSD1306_HEIGHT / 8
@@ -123,7 +122,8 @@ typedef enum {
 
 typedef enum {
     SSD1306_OK = 0x00,
-    SSD1306_ERR = 0x01  // Generic error.
+    SSD1306_ERR = 0x01,  // Generic error.
+    SSD1306_BUSY = 0x02  // A frame is still being transferred.
 } SSD1306_Error_t;
 
 // Struct to store transformations
@@ -132,6 +132,10 @@ typedef struct {
     uint16_t CurrentY;
     uint8_t Initialized;
     uint8_t DisplayOn;
+    uint8_t FullRefresh;        // Next flush ignores the copy of the display RAM
+    uint32_t LastFlushBytes;    // Command and data bytes of the last flush
+    uint32_t DeferredFrames;    // Async flushes refused while a frame was in flight
+    uint8_t Degraded;           // A transfer failed, flushes are skipped until ssd1306_Init
 } SSD1306_t;
 
 typedef struct {
@@ -139,10 +143,46 @@ typedef struct {
     uint8_t y;
 } SSD1306_VERTEX;
 
+// Buffer the drawing primitives draw in: pages of width bytes, top row in bit 0
+typedef struct {
+    uint8_t* buffer;    // width * ((height + 7) / 8) bytes
+    uint8_t width;
+    uint8_t height;
+} SSD1306_Target_t;
+
+// Icon of an atlas, page-native like the fonts: the column bytes of each page, top page first
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t rle;        // Data is run-length encoded, see ssd1306_DrawIcon
+    const uint8_t* data;
+} SSD1306_Icon_t;
+
+// How the lit pixels of an icon meet the buffer
+typedef enum {
+    SSD1306_ICON_OPAQUE,    // Lit pixels white, the others black
+    SSD1306_ICON_SET,       // Lit pixels white, the others kept: transparent background
+    SSD1306_ICON_CLEAR,     // Lit pixels black, the others kept
+    SSD1306_ICON_XOR        // Lit pixels inverted, the others kept
+} SSD1306_IconMode_t;
+
 // Procedure definitions
 void ssd1306_Init(void);
 void ssd1306_Fill(SSD1306_COLOR color);
 void ssd1306_UpdateScreen(void);
+void ssd1306_Invalidate(void);
+SSD1306_Error_t ssd1306_UpdateScreenAsync(void);
+uint8_t ssd1306_IsFrameInFlight(void);
+uint32_t ssd1306_GetDeferredFrames(void);
+uint8_t ssd1306_IsDegraded(void);
+void ssd1306_TransferCompleteCallback(void);
+void ssd1306_TransferErrorCallback(void);
+uint32_t ssd1306_GetLastFlushBytes(void);
+void ssd1306_SetTarget(const SSD1306_Target_t* target);
+const SSD1306_Target_t* ssd1306_GetTarget(void);
+const SSD1306_Target_t* ssd1306_GetScreenTarget(void);
+void ssd1306_BlitTarget(const SSD1306_Target_t* source, uint8_t x, uint8_t y);
+void ssd1306_DrawIcon(uint8_t x, uint8_t y, const SSD1306_Icon_t* icon, SSD1306_IconMode_t mode);
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 char ssd1306_WriteChar(char ch, FontDef Font, SSD1306_COLOR color);
 char ssd1306_WriteString(char* str, FontDef Font, SSD1306_COLOR color);
@@ -150,11 +190,19 @@ void ssd1306_SetCursor(uint8_t x, uint8_t y);
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
 void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+void ssd1306_DrawArcFloat(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+void ssd1306_DrawArcWithRadiusLineFloat(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+void ssd1306_DrawRadiusLine(uint8_t x, uint8_t y, uint8_t inner_radius, uint8_t outer_radius, uint16_t angle, SSD1306_COLOR color);
+int32_t ssd1306_Sin(uint16_t par_deg);
+int32_t ssd1306_Cos(uint16_t par_deg);
 void ssd1306_DrawCircle(uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR color);
 void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color);
 void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD1306_COLOR color);
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color);
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_ClearRegion(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color);
 
 /**
@@ -181,6 +229,7 @@ uint8_t ssd1306_GetDisplayOn();
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
+void ssd1306_WriteCommands(const uint8_t* commands, size_t count);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
 
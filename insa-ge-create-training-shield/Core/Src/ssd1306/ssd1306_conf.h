@@ -35,6 +35,16 @@
 //#define SSD1306_Reset_Port      OLED_Res_GPIO_Port
 //#define SSD1306_Reset_Pin       OLED_Res_Pin
 
+// Send frames with DMA from ssd1306_UpdateScreenAsync (I2C only). The
+// application forwards the HAL I2C completion and error callbacks to
+// ssd1306_TransferCompleteCallback and ssd1306_TransferErrorCallback
+#define SSD1306_USE_DMA
+
+// Longest wait for one transfer (ms), a full frame at 100 kHz takes ~50 ms.
+// A transfer that fails or times out marks the display degraded, see
+// ssd1306_IsDegraded; ssd1306_Init brings it back
+#define SSD1306_TIMEOUT_MS      100
+
 // Mirror the screen if needed
 // #define SSD1306_MIRROR_VERT
 // #define SSD1306_MIRROR_HORIZ
@@ -42,6 +52,10 @@
 // Set inverse color if needed
 // # define SSD1306_INVERSE_COLOR
 
+// Arcs are rasterized with integers only. Define this to use the
+// sin/cos segment versions instead (slow without an FPU)
+// #define SSD1306_USE_FLOAT_TRIG
+
 // Include only needed fonts
 #define SSD1306_INCLUDE_FONT_6x8
 #define SSD1306_INCLUDE_FONT_7x10
@@ -49,18 +63,24 @@
 #define SSD1306_INCLUDE_FONT_16x26
 
 #define SSD1306_INCLUDE_FONT_16x24
+#define SSD1306_INCLUDE_FONT_DIGITS_11x16
 
-// The width of the screen can be set using this
-// define. The default value is 128.
-#define SSD1306_WIDTH           128
+// Keep only the characters the firmware prints in the fonts it uses, see
+// Tools/font_subset.py. The ssd1306 tests print every character: they are
+// built with -DSSD1306_TESTS, which keeps the full fonts
+#ifndef SSD1306_TESTS
+#define SSD1306_USE_FONT_SUBSET
+#endif
 
-// If your screen horizontal axis does not start
-// in column 0 you can use this define to
-// adjust the horizontal offset
-// #define SSD1306_X_OFFSET
+// Display panel, see ssd1306_panels.h. Another panel can be selected
+// from the build with -DSSD1306_PANEL=SSD1306_PANEL_128x64 for example
+#ifndef SSD1306_PANEL
+#define SSD1306_PANEL           SSD1306_PANEL_128x32
+#endif
 
-// The height can be changed as well if necessary.
-// It can be 32, 64 or 128. The default value is 64.
-#define SSD1306_HEIGHT          32
+// With SSD1306_PANEL_CUSTOM, the geometry is set with these instead:
+// #define SSD1306_WIDTH        128     // Default 128
+// #define SSD1306_HEIGHT       64      // 32, 64 or 128, default 64
+// #define SSD1306_X_OFFSET     0       // First RAM column shown
 
 #endif /* __SSD1306_CONF_H__ */
@@ -5,12 +5,27 @@
 
 #include "ssd1306_conf.h"
 
+#ifdef SSD1306_USE_FONT_SUBSET
+#include "ssd1306_fonts_subset.h"
+#endif
+
+/*
+ * Glyphs are stored the way the display RAM is organised: for each 8-row
+ * page of the glyph, one byte per column with the top row in bit 0. A
+ * glyph takes FontWidth * ((FontHeight + 7) / 8) bytes, pages in order.
+ * A full font holds the 95 characters from ' ' to '~'; a subset font made
+ * by Tools/font_subset.py holds fewer, and map gives the glyph number of
+ * each character from ' ' (0xFF when it was left out)
+ */
 typedef struct {
 	const uint8_t FontWidth;    /*!< Font width in pixels */
 	uint8_t FontHeight;   /*!< Font height in pixels */
-	const uint16_t *data; /*!< Pointer to data font data array */
+	const uint8_t *data;  /*!< Pointer to data font data array */
+	const uint8_t *map;   /*!< Glyph number of each character, NULL for a full font */
 } FontDef;
 
+#define SSD1306_GLYPH_MISSING 0xFF
+
 #ifdef SSD1306_INCLUDE_FONT_6x8
 extern FontDef Font_6x8;
 #endif
@@ -26,4 +41,7 @@ extern FontDef Font_16x26;
 #ifdef SSD1306_INCLUDE_FONT_16x24
 extern FontDef Font_16x24;
 #endif
+#ifdef SSD1306_INCLUDE_FONT_DIGITS_11x16
+extern FontDef Font_Digits_11x16;
+#endif
 #endif // __SSD1306_FONTS_H__
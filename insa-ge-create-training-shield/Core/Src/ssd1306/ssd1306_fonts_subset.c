@@ -0,0 +1,181 @@
+/*
+ * Subset fonts generated by Tools/font_subset.py, do not edit.
+ * Characters:  ()+-./0123456789:=>?ABCDEFGHIKLMNOPRSTUVWXY^abcdefghiklmnoprstuvwxyz
+ * Flash saved against the full fonts: 330 bytes
+ */
+
+#include "ssd1306_fonts.h"
+
+#ifdef SSD1306_USE_FONT_SUBSET
+
+#ifdef SSD1306_INCLUDE_FONT_6x8
+static const uint8_t Font6x8_Subset [] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // sp
+0x00, 0x1C, 0x22, 0x41, 0x00, 0x00,  // (
+0x00, 0x41, 0x22, 0x1C, 0x00, 0x00,  // )
+0x08, 0x08, 0x3E, 0x08, 0x08, 0x00,  // +
+0x08, 0x08, 0x08, 0x08, 0x08, 0x00,  // -
+0x00, 0x00, 0x60, 0x60, 0x00, 0x00,  // .
+0x20, 0x10, 0x08, 0x04, 0x02, 0x00,  // /
+0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00,  // 0
+0x00, 0x42, 0x7F, 0x40, 0x00, 0x00,  // 1
+0x72, 0x49, 0x49, 0x49, 0x46, 0x00,  // 2
+0x21, 0x41, 0x49, 0x4D, 0x33, 0x00,  // 3
+0x18, 0x14, 0x12, 0x7F, 0x10, 0x00,  // 4
+0x27, 0x45, 0x45, 0x45, 0x39, 0x00,  // 5
+0x3C, 0x4A, 0x49, 0x49, 0x31, 0x00,  // 6
+0x41, 0x21, 0x11, 0x09, 0x07, 0x00,  // 7
+0x36, 0x49, 0x49, 0x49, 0x36, 0x00,  // 8
+0x46, 0x49, 0x49, 0x29, 0x1E, 0x00,  // 9
+0x00, 0x00, 0x14, 0x00, 0x00, 0x00,  // :
+0x14, 0x14, 0x14, 0x14, 0x14, 0x00,  // =
+0x00, 0x41, 0x22, 0x14, 0x08, 0x00,  // >
+0x02, 0x01, 0x59, 0x09, 0x06, 0x00,  // ?
+0x7C, 0x12, 0x11, 0x12, 0x7C, 0x00,  // A
+0x7F, 0x49, 0x49, 0x49, 0x36, 0x00,  // B
+0x3E, 0x41, 0x41, 0x41, 0x22, 0x00,  // C
+0x7F, 0x41, 0x41, 0x41, 0x3E, 0x00,  // D
+0x7F, 0x49, 0x49, 0x49, 0x41, 0x00,  // E
+0x7F, 0x09, 0x09, 0x09, 0x01, 0x00,  // F
+0x3E, 0x41, 0x41, 0x51, 0x73, 0x00,  // G
+0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00,  // H
+0x00, 0x41, 0x7F, 0x41, 0x00, 0x00,  // I
+0x7F, 0x08, 0x14, 0x22, 0x41, 0x00,  // K
+0x7F, 0x40, 0x40, 0x40, 0x40, 0x00,  // L
+0x7F, 0x02, 0x1C, 0x02, 0x7F, 0x00,  // M
+0x7F, 0x04, 0x08, 0x10, 0x7F, 0x00,  // N
+0x3E, 0x41, 0x41, 0x41, 0x3E, 0x00,  // O
+0x7F, 0x09, 0x09, 0x09, 0x06, 0x00,  // P
+0x7F, 0x09, 0x19, 0x29, 0x46, 0x00,  // R
+0x26, 0x49, 0x49, 0x49, 0x32, 0x00,  // S
+0x03, 0x01, 0x7F, 0x01, 0x03, 0x00,  // T
+0x3F, 0x40, 0x40, 0x40, 0x3F, 0x00,  // U
+0x1F, 0x20, 0x40, 0x20, 0x1F, 0x00,  // V
+0x3F, 0x40, 0x38, 0x40, 0x3F, 0x00,  // W
+0x63, 0x14, 0x08, 0x14, 0x63, 0x00,  // X
+0x03, 0x04, 0x78, 0x04, 0x03, 0x00,  // Y
+0x04, 0x02, 0x01, 0x02, 0x04, 0x00,  // ^
+0x20, 0x54, 0x54, 0x78, 0x40, 0x00,  // a
+0x7F, 0x28, 0x44, 0x44, 0x38, 0x00,  // b
+0x38, 0x44, 0x44, 0x44, 0x28, 0x00,  // c
+0x38, 0x44, 0x44, 0x28, 0x7F, 0x00,  // d
+0x38, 0x54, 0x54, 0x54, 0x18, 0x00,  // e
+0x00, 0x08, 0x7E, 0x09, 0x02, 0x00,  // f
+0x18, 0x24, 0x24, 0x1C, 0x78, 0x00,  // g
+0x7F, 0x08, 0x04, 0x04, 0x78, 0x00,  // h
+0x00, 0x44, 0x7D, 0x40, 0x00, 0x00,  // i
+0x7F, 0x10, 0x28, 0x44, 0x00, 0x00,  // k
+0x00, 0x41, 0x7F, 0x40, 0x00, 0x00,  // l
+0x7C, 0x04, 0x78, 0x04, 0x78, 0x00,  // m
+0x7C, 0x08, 0x04, 0x04, 0x78, 0x00,  // n
+0x38, 0x44, 0x44, 0x44, 0x38, 0x00,  // o
+0x7C, 0x18, 0x24, 0x24, 0x18, 0x00,  // p
+0x7C, 0x08, 0x04, 0x04, 0x08, 0x00,  // r
+0x48, 0x54, 0x54, 0x54, 0x24, 0x00,  // s
+0x04, 0x04, 0x3F, 0x44, 0x24, 0x00,  // t
+0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00,  // u
+0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00,  // v
+0x3C, 0x40, 0x30, 0x40, 0x3C, 0x00,  // w
+0x44, 0x28, 0x10, 0x28, 0x44, 0x00,  // x
+0x4C, 0x10, 0x10, 0x10, 0x7C, 0x00,  // y
+0x44, 0x64, 0x54, 0x4C, 0x44, 0x00,  // z
+};
+
+static const uint8_t Font6x8_Map [] = {
+0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x02, 0xFF, 0x03, 0xFF, 0x04, 0x05, 0x06,
+0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0xFF, 0xFF, 0x12, 0x13, 0x14,
+0xFF, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0xFF, 0x1E, 0x1F, 0x20, 0x21, 0x22,
+0x23, 0xFF, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0xFF, 0xFF, 0xFF, 0xFF, 0x2C, 0xFF,
+0xFF, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0xFF, 0x36, 0x37, 0x38, 0x39, 0x3A,
+0x3B, 0xFF, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+FontDef Font_6x8 = {6,8,Font6x8_Subset,Font6x8_Map};
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_7x10
+static const uint8_t Font7x10_Subset [] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // sp
+0x00, 0x00, 0xFC, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x00,  // (
+0x00, 0x00, 0x01, 0x02, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00,  // )
+0x00, 0x10, 0x10, 0x7C, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // +
+0x00, 0x00, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // -
+0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // .
+0x00, 0x00, 0xC0, 0x3C, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // /
+0x00, 0x7E, 0x81, 0x89, 0x81, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0
+0x00, 0x04, 0x02, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 1
+0x00, 0x86, 0xC1, 0xA1, 0x91, 0x8E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 2
+0x00, 0x42, 0x81, 0x89, 0x89, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 3
+0x00, 0x30, 0x2C, 0x22, 0xFF, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 4
+0x00, 0x4F, 0x89, 0x89, 0x89, 0x71, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 5
+0x00, 0x7E, 0x89, 0x89, 0x89, 0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 6
+0x00, 0x01, 0xE1, 0x19, 0x05, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 7
+0x00, 0x76, 0x89, 0x89, 0x89, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 8
+0x00, 0x4E, 0x91, 0x91, 0x91, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 9
+0x00, 0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // :
+0x00, 0x28, 0x28, 0x28, 0x28, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // =
+0x00, 0x44, 0x44, 0x28, 0x28, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // >
+0x00, 0x02, 0x01, 0xB1, 0x09, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ?
+0x00, 0xE0, 0x3E, 0x21, 0x3E, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // A
+0x00, 0xFF, 0x89, 0x89, 0x89, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // B
+0x00, 0x7E, 0x81, 0x81, 0x81, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // C
+0x00, 0xFF, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // D
+0x00, 0xFF, 0x89, 0x89, 0x89, 0x89, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // E
+0x00, 0xFF, 0x09, 0x09, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // F
+0x00, 0x7E, 0x81, 0x91, 0x91, 0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // G
+0x00, 0xFF, 0x08, 0x08, 0x08, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // H
+0x00, 0x00, 0x81, 0xFF, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // I
+0x00, 0xFF, 0x08, 0x14, 0x62, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // K
+0x00, 0xFF, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // L
+0x00, 0xFF, 0x06, 0x08, 0x06, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // M
+0x00, 0xFF, 0x06, 0x18, 0x60, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // N
+0x00, 0x7E, 0x81, 0x81, 0x81, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // O
+0x00, 0xFF, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // P
+0x00, 0xFF, 0x11, 0x11, 0x71, 0x8E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // R
+0x00, 0x46, 0x89, 0x89, 0x91, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // S
+0x00, 0x01, 0x01, 0xFF, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // T
+0x00, 0x7F, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U
+0x00, 0x07, 0x38, 0xC0, 0x38, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // V
+0x00, 0x3F, 0xE0, 0x1C, 0xE0, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // W
+0x00, 0x81, 0x66, 0x18, 0x66, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // X
+0x00, 0x03, 0x0C, 0xF0, 0x0C, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Y
+0x00, 0x08, 0x06, 0x01, 0x06, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ^
+0x00, 0x68, 0x94, 0x94, 0x54, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // a
+0x00, 0xFF, 0x48, 0x84, 0x84, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // b
+0x00, 0x78, 0x84, 0x84, 0x84, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // c
+0x00, 0x78, 0x84, 0x84, 0x48, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // d
+0x00, 0x78, 0x94, 0x94, 0x94, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // e
+0x00, 0x04, 0x04, 0xFE, 0x05, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // f
+0x00, 0x78, 0x84, 0x84, 0x48, 0xFC, 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x01, 0x00,  // g
+0x00, 0xFF, 0x08, 0x04, 0x04, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // h
+0x00, 0x04, 0x04, 0xFD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // i
+0x00, 0xFF, 0x10, 0x28, 0x44, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // k
+0x00, 0x01, 0x01, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // l
+0x00, 0xFC, 0x04, 0xFC, 0x04, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // m
+0x00, 0xFC, 0x08, 0x04, 0x04, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // n
+0x00, 0x78, 0x84, 0x84, 0x84, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // o
+0x00, 0xFC, 0x48, 0x84, 0x84, 0x78, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,  // p
+0x00, 0xFC, 0x08, 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // r
+0x00, 0x48, 0x94, 0x94, 0xA4, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // s
+0x00, 0x04, 0x7F, 0x84, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // t
+0x00, 0x7C, 0x80, 0x80, 0x40, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // u
+0x00, 0x0C, 0x70, 0x80, 0x70, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // v
+0x00, 0x3C, 0xE0, 0x1C, 0xE0, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // w
+0x00, 0x84, 0x48, 0x30, 0x48, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // x
+0x00, 0x0C, 0x30, 0xC0, 0x30, 0x0C, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,  // y
+0x00, 0xC4, 0xA4, 0x94, 0x8C, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // z
+};
+
+static const uint8_t Font7x10_Map [] = {
+0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x02, 0xFF, 0x03, 0xFF, 0x04, 0x05, 0x06,
+0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0xFF, 0xFF, 0x12, 0x13, 0x14,
+0xFF, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0xFF, 0x1E, 0x1F, 0x20, 0x21, 0x22,
+0x23, 0xFF, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0xFF, 0xFF, 0xFF, 0xFF, 0x2C, 0xFF,
+0xFF, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0xFF, 0x36, 0x37, 0x38, 0x39, 0x3A,
+0x3B, 0xFF, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+FontDef Font_7x10 = {7,10,Font7x10_Subset,Font7x10_Map};
+#endif
+
+#endif // SSD1306_USE_FONT_SUBSET
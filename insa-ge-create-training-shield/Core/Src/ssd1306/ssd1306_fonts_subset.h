@@ -0,0 +1,12 @@
+/*
+ * Subset fonts generated by Tools/font_subset.py, do not edit.
+ * Fonts listed here replace the full tables of ssd1306_fonts.c
+ */
+
+#ifndef __SSD1306_FONTS_SUBSET_H__
+#define __SSD1306_FONTS_SUBSET_H__
+
+#define SSD1306_SUBSET_FONT_6x8
+#define SSD1306_SUBSET_FONT_7x10
+
+#endif // __SSD1306_FONTS_SUBSET_H__
@@ -0,0 +1,30 @@
+/*
+ * Icon atlas generated by Tools/icon_atlas.py from Tools/icons.txt, do not edit.
+ */
+
+#include "ssd1306_icons.h"
+
+static const uint8_t IconAlarm_Data [] = {
+0x20, 0x3C, 0x3E, 0xBF, 0xBF, 0x3E, 0x3C, 0x20,
+};
+const SSD1306_Icon_t Icon_Alarm = {8,8,0,IconAlarm_Data};
+
+static const uint8_t IconLogging_Data [] = {
+0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C,
+};
+const SSD1306_Icon_t Icon_Logging = {8,8,0,IconLogging_Data};
+
+static const uint8_t IconLink_Data [] = {
+0x1C, 0x22, 0x22, 0x1C, 0x1C, 0x22, 0x22, 0x1C,
+};
+const SSD1306_Icon_t Icon_Link = {8,8,0,IconLink_Data};
+
+static const uint8_t IconBattery_Data [] = {
+0x01, 0xFF, 0x81, 0x87, 0xBD, 0x03, 0x81, 0xFF, 0x3C, 0x3C,
+};
+const SSD1306_Icon_t Icon_Battery = {14,8,1,IconBattery_Data};
+
+static const uint8_t IconCalibration_Data [] = {
+0x83, 0xC5, 0xA9, 0xD1, 0xA9, 0xC5, 0x83,
+};
+const SSD1306_Icon_t Icon_Calibration = {7,8,0,IconCalibration_Data};
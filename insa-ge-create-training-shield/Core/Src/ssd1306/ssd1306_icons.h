@@ -0,0 +1,17 @@
+/*
+ * Icon atlas generated by Tools/icon_atlas.py, do not edit.
+ * Draw the icons with ssd1306_DrawIcon
+ */
+
+#ifndef __SSD1306_ICONS_H__
+#define __SSD1306_ICONS_H__
+
+#include "ssd1306.h"
+
+extern const SSD1306_Icon_t Icon_Alarm;
+extern const SSD1306_Icon_t Icon_Logging;
+extern const SSD1306_Icon_t Icon_Link;
+extern const SSD1306_Icon_t Icon_Battery;
+extern const SSD1306_Icon_t Icon_Calibration;
+
+#endif // __SSD1306_ICONS_H__
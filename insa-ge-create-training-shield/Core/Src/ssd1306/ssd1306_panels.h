@@ -0,0 +1,73 @@
+#ifndef __SSD1306_PANELS_H__
+#define __SSD1306_PANELS_H__
+
+/*
+ * Display panels the driver knows. Select one with SSD1306_PANEL, in
+ * ssd1306_conf.h or on the compiler command line. A panel fixes the
+ * geometry and the controller at compile time: the buffer addressing,
+ * the init sequence and the flush commands of the selected panel are
+ * constants, and the code of the other controllers is not built.
+ *
+ * SSD1306_PANEL_CUSTOM keeps the SSD1306_WIDTH, SSD1306_HEIGHT and
+ * SSD1306_X_OFFSET settings of older configurations.
+ */
+#define SSD1306_PANEL_CUSTOM            0
+#define SSD1306_PANEL_128x32            1   // SSD1306, 0.91" 128x32
+#define SSD1306_PANEL_128x64            2   // SSD1306, 0.96" 128x64
+#define SSD1306_PANEL_SH1106_128x64     3   // SH1106, 1.3" 128x64 shown from column 2 of 132
+
+#define SSD1306_CONTROLLER_SSD1306      0   // Horizontal addressing, flushed by column/page windows
+#define SSD1306_CONTROLLER_SH1106       1   // Page addressing only, flushed one page at a time
+
+#ifndef SSD1306_PANEL
+#define SSD1306_PANEL SSD1306_PANEL_CUSTOM
+#endif
+
+#if (SSD1306_PANEL != SSD1306_PANEL_CUSTOM) && (defined(SSD1306_WIDTH) || defined(SSD1306_HEIGHT) || defined(SSD1306_X_OFFSET))
+#error "SSD1306_PANEL sets the geometry, remove SSD1306_WIDTH, SSD1306_HEIGHT and SSD1306_X_OFFSET"
+#endif
+
+#if (SSD1306_PANEL == SSD1306_PANEL_128x32)
+#define SSD1306_WIDTH           128
+#define SSD1306_HEIGHT          32
+#define SSD1306_COLUMN_OFFSET   0
+#define SSD1306_CONTROLLER      SSD1306_CONTROLLER_SSD1306
+#elif (SSD1306_PANEL == SSD1306_PANEL_128x64)
+#define SSD1306_WIDTH           128
+#define SSD1306_HEIGHT          64
+#define SSD1306_COLUMN_OFFSET   0
+#define SSD1306_CONTROLLER      SSD1306_CONTROLLER_SSD1306
+#elif (SSD1306_PANEL == SSD1306_PANEL_SH1106_128x64)
+#define SSD1306_WIDTH           128
+#define SSD1306_HEIGHT          64
+#define SSD1306_COLUMN_OFFSET   2
+#define SSD1306_CONTROLLER      SSD1306_CONTROLLER_SH1106
+#elif (SSD1306_PANEL == SSD1306_PANEL_CUSTOM)
+#ifndef SSD1306_WIDTH
+#define SSD1306_WIDTH           128
+#endif
+#ifndef SSD1306_HEIGHT
+#define SSD1306_HEIGHT          64
+#endif
+#ifdef SSD1306_X_OFFSET
+#define SSD1306_COLUMN_OFFSET   (SSD1306_X_OFFSET)
+#else
+#define SSD1306_COLUMN_OFFSET   0
+#endif
+#define SSD1306_CONTROLLER      SSD1306_CONTROLLER_SSD1306
+#else
+#error "Unknown SSD1306_PANEL"
+#endif
+
+// Controller settings that follow from the height
+#if (SSD1306_HEIGHT == 32)
+#define SSD1306_MULTIPLEX       0x1F
+#define SSD1306_COM_PINS        0x02    // Sequential COM pins
+#elif (SSD1306_HEIGHT == 64) || (SSD1306_HEIGHT == 128)
+#define SSD1306_MULTIPLEX       0x3F    // Seems to work for 128px high displays too
+#define SSD1306_COM_PINS        0x12    // Alternative COM pins
+#else
+#error "Only 32, 64, or 128 lines of height are supported!"
+#endif
+
+#endif /* __SSD1306_PANELS_H__ */
@@ -2,6 +2,11 @@
 #include <stdio.h>
 #include "ssd1306.h"
 #include "ssd1306_tests.h"
+#include "i2c_timing.h"
+
+// The tests print characters the subset fonts leave out, so they are only
+// built with -DSSD1306_TESTS, which keeps the full fonts (see ssd1306_conf.h)
+#ifdef SSD1306_TESTS
 
 //------------------------------------------------------------------------------
 // Table generated by LCD Assistant
@@ -231,6 +236,178 @@ void ssd1306_TestFPS() {
     ssd1306_UpdateScreen();
 }
 
+/*
+ * Runs the ssd1306_TestFPS frame loop for duration_ms with every frame sent
+ * in full, so the result measures the bus rather than the dirty tracking.
+ * Returns the frame rate and stores the I2C payload rate in bytes_per_s
+ */
+uint32_t ssd1306_MeasureFPS(uint32_t duration_ms, uint32_t* bytes_per_s) {
+    uint32_t start = HAL_GetTick();
+    uint32_t end = start;
+    uint32_t frames = 0;
+    uint32_t bytes = 0;
+    char message[] = "ABCDEFGHIJK";
+
+    ssd1306_Fill(White);
+    ssd1306_SetCursor(2,0);
+    ssd1306_WriteString("Testing...", Font_11x18, Black);
+
+    do {
+        ssd1306_SetCursor(2, 18);
+        ssd1306_WriteString(message, Font_11x18, Black);
+        ssd1306_Invalidate();
+        ssd1306_UpdateScreen();
+        bytes += ssd1306_GetLastFlushBytes();
+
+        char ch = message[0];
+        memmove(message, message+1, sizeof(message)-2);
+        message[sizeof(message)-2] = ch;
+
+        frames++;
+        end = HAL_GetTick();
+    } while((end - start) < duration_ms);
+
+    *bytes_per_s = bytes * 1000 / (end - start);
+    return frames * 1000 / (end - start);
+}
+
+/*
+ * Measures the frame rate and bus throughput of every I2C speed profile,
+ * then restores the profile that was active
+ */
+void ssd1306_TestFPSProfiles() {
+    I2C_Profile_t previous = I2C_Timing_Get_Profile();
+    uint32_t fps[I2C_PROFILE_COUNT];
+    uint32_t bytes_per_s[I2C_PROFILE_COUNT];
+    char buff[24];
+    uint8_t profile;
+
+    for(profile = 0; profile < I2C_PROFILE_COUNT; profile++) {
+        if(I2C_Timing_Apply(&SSD1306_I2C_PORT, (I2C_Profile_t)profile) != HAL_OK) {
+            fps[profile] = 0;
+            bytes_per_s[profile] = 0;
+            continue;
+        }
+        fps[profile] = ssd1306_MeasureFPS(2000, &bytes_per_s[profile]);
+    }
+    I2C_Timing_Apply(&SSD1306_I2C_PORT, previous);
+
+    ssd1306_Fill(Black);
+    for(profile = 0; profile < I2C_PROFILE_COUNT; profile++) {
+        snprintf(buff, sizeof(buff), "%-4s %3lufps %5luB/s", I2C_Timing_Get_Name((I2C_Profile_t)profile),
+                 (unsigned long)fps[profile], (unsigned long)bytes_per_s[profile]);
+        ssd1306_SetCursor(0, profile * 10);
+        ssd1306_WriteString(buff, Font_6x8, White);
+    }
+    ssd1306_UpdateScreen();
+}
+
+/*
+ * Shows the bytes sent by ssd1306_UpdateScreen for a full frame, for the
+ * same frame redrawn and for a frame where one digit changed
+ */
+void ssd1306_TestFlushBytes() {
+    uint32_t full_bytes, same_bytes, digit_bytes;
+    char buff[24];
+
+    ssd1306_Invalidate();
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("V:12.3V  I:1.25A", Font_7x10, White);
+    ssd1306_UpdateScreen();
+    full_bytes = ssd1306_GetLastFlushBytes();
+
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("V:12.3V  I:1.25A", Font_7x10, White);
+    ssd1306_UpdateScreen();
+    same_bytes = ssd1306_GetLastFlushBytes();
+
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("V:12.4V  I:1.25A", Font_7x10, White);
+    ssd1306_UpdateScreen();
+    digit_bytes = ssd1306_GetLastFlushBytes();
+
+    snprintf(buff, sizeof(buff), "full:%lu same:%lu", (unsigned long)full_bytes, (unsigned long)same_bytes);
+    ssd1306_SetCursor(0, 12);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "one digit:%lu", (unsigned long)digit_bytes);
+    ssd1306_SetCursor(0, 22);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    ssd1306_UpdateScreen();
+}
+
+/*
+ * Pixel by pixel text drawing, the way ssd1306_WriteChar used to work.
+ * Reference for ssd1306_TestTextSpeed
+ */
+static void ssd1306_TestWriteStringPixels(uint8_t x, uint8_t y, char* str, FontDef Font, SSD1306_COLOR color) {
+    uint8_t pages = (Font.FontHeight + 7) / 8;
+
+    for(; *str; str++, x += Font.FontWidth) {
+        uint8_t index = (Font.map != NULL) ? Font.map[*str - 32] : *str - 32;
+        const uint8_t* glyph = &Font.data[index * Font.FontWidth * pages];
+
+        for(uint8_t i = 0; i < Font.FontHeight; i++) {
+            for(uint8_t j = 0; j < Font.FontWidth; j++) {
+                if((glyph[(i / 8) * Font.FontWidth + j] >> (i % 8)) & 1) {
+                    ssd1306_DrawPixel(x + j, y + i, color);
+                } else {
+                    ssd1306_DrawPixel(x + j, y + i, (SSD1306_COLOR)!color);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Times 100 lines of Font_7x10 text drawn pixel by pixel and with the
+ * byte blitter of ssd1306_WriteChar, at a row that straddles two pages.
+ * Redrawing the blitter output with the pixel version must send nothing
+ */
+void ssd1306_TestTextSpeed() {
+    char text[] = "V:12.34V I:1.2A";
+    uint32_t start;
+    uint32_t pixel_time;
+    uint32_t blit_time;
+    uint32_t diff_bytes;
+    char buff[24];
+    uint8_t i;
+
+    ssd1306_Fill(Black);
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        ssd1306_TestWriteStringPixels(2, 3, text, Font_7x10, (SSD1306_COLOR)(i & 1));
+    }
+    pixel_time = HAL_GetTick() - start;
+
+    ssd1306_Fill(Black);
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        ssd1306_SetCursor(2, 3);
+        ssd1306_WriteString(text, Font_7x10, (SSD1306_COLOR)(i & 1));
+    }
+    blit_time = HAL_GetTick() - start;
+
+    ssd1306_UpdateScreen();
+    ssd1306_TestWriteStringPixels(2, 3, text, Font_7x10, White);
+    ssd1306_UpdateScreen();
+    diff_bytes = ssd1306_GetLastFlushBytes();
+    HAL_Delay(2000);
+
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString("Text x100", Font_6x8, White);
+    snprintf(buff, sizeof(buff), "pixels: %lums", (unsigned long)pixel_time);
+    ssd1306_SetCursor(2, 10);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "bytes: %lums d:%lu", (unsigned long)blit_time, (unsigned long)diff_bytes);
+    ssd1306_SetCursor(2, 20);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    ssd1306_UpdateScreen();
+}
+
 void ssd1306_TestLine() {
 
   ssd1306_Line(1,1,SSD1306_WIDTH - 1,SSD1306_HEIGHT - 1,White);
@@ -257,28 +434,253 @@ void ssd1306_TestRectangleFill() {
   ssd1306_UpdateScreen();
 }
 
+/*
+ * Draws the circles 100 times, shows them, then the time of the outlines
+ * and of the filled circles
+ */
 void ssd1306_TestCircle() {
   uint32_t delta;
-
-  for(delta = 0; delta < 5; delta ++) {
-    ssd1306_DrawCircle(20*delta+30, 15, 10, White);
+  uint32_t start;
+  uint32_t outline_time;
+  uint32_t fill_time;
+  char buff[24];
+  uint8_t i;
+
+  start = HAL_GetTick();
+  for(i = 0; i < 100; i++) {
+    for(delta = 0; delta < 5; delta ++) {
+      ssd1306_DrawCircle(20*delta+30, 15, 10, White);
+    }
   }
+  outline_time = HAL_GetTick() - start;
 
-  for(delta = 0; delta < 5; delta ++) {
-    ssd1306_FillCircle(23*delta+15, 40, 10, White);
+  start = HAL_GetTick();
+  for(i = 0; i < 100; i++) {
+    for(delta = 0; delta < 5; delta ++) {
+      ssd1306_FillCircle(23*delta+15, 40, 10, White);
+    }
   }
+  fill_time = HAL_GetTick() - start;
 
+  ssd1306_UpdateScreen();
+  HAL_Delay(2000);
+
+  ssd1306_Fill(Black);
+  ssd1306_SetCursor(2, 0);
+  ssd1306_WriteString("Circles x100", Font_6x8, White);
+  snprintf(buff, sizeof(buff), "outline: %lums", (unsigned long)outline_time);
+  ssd1306_SetCursor(2, 10);
+  ssd1306_WriteString(buff, Font_6x8, White);
+  snprintf(buff, sizeof(buff), "filled:  %lums", (unsigned long)fill_time);
+  ssd1306_SetCursor(2, 20);
+  ssd1306_WriteString(buff, Font_6x8, White);
   ssd1306_UpdateScreen();
   return;
 }
 
+/*
+ * Draws both arcs 100 times, shows them, then the time of each
+ */
 void ssd1306_TestArc() {
-  ssd1306_DrawArc(30, 30, 30, 20, 270, White);
-  ssd1306_DrawArcWithRadiusLine(80, 55, 10, 30, 270, White);
+  uint32_t start;
+  uint32_t arc_time;
+  uint32_t radius_time;
+  char buff[24];
+  uint8_t i;
+
+  start = HAL_GetTick();
+  for(i = 0; i < 100; i++) {
+    ssd1306_DrawArc(30, 30, 30, 20, 270, White);
+  }
+  arc_time = HAL_GetTick() - start;
+
+  start = HAL_GetTick();
+  for(i = 0; i < 100; i++) {
+    ssd1306_DrawArcWithRadiusLine(80, 55, 10, 30, 270, White);
+  }
+  radius_time = HAL_GetTick() - start;
+
+  ssd1306_UpdateScreen();
+  HAL_Delay(2000);
+
+  ssd1306_Fill(Black);
+  ssd1306_SetCursor(2, 0);
+  ssd1306_WriteString("Arcs x100", Font_6x8, White);
+  snprintf(buff, sizeof(buff), "arc:    %lums", (unsigned long)arc_time);
+  ssd1306_SetCursor(2, 10);
+  ssd1306_WriteString(buff, Font_6x8, White);
+  snprintf(buff, sizeof(buff), "radius: %lums", (unsigned long)radius_time);
+  ssd1306_SetCursor(2, 20);
+  ssd1306_WriteString(buff, Font_6x8, White);
   ssd1306_UpdateScreen();
   return;
 }
 
+/*
+ * Draws the same gauge 100 times with the integer arcs and with the
+ * sin/cos fallback, then shows both times
+ */
+void ssd1306_TestArcSpeed() {
+    uint32_t start;
+    uint32_t float_time;
+    uint32_t integer_time;
+    char buff[24];
+    uint8_t i;
+
+    ssd1306_Fill(Black);
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        ssd1306_DrawArcFloat(30, 31, 28, 90, 270, White);
+        ssd1306_DrawArcWithRadiusLineFloat(96, 31, 20, 90, 270, White);
+    }
+    float_time = HAL_GetTick() - start;
+
+    ssd1306_Fill(Black);
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        ssd1306_DrawArc(30, 31, 28, 90, 270, White);
+        ssd1306_DrawArcWithRadiusLine(96, 31, 20, 90, 270, White);
+    }
+    integer_time = HAL_GetTick() - start;
+    ssd1306_UpdateScreen();
+    HAL_Delay(2000);
+
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString("Arcs x100", Font_6x8, White);
+    snprintf(buff, sizeof(buff), "sin/cos: %lums", (unsigned long)float_time);
+    ssd1306_SetCursor(2, 10);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "integer: %lums", (unsigned long)integer_time);
+    ssd1306_SetCursor(2, 20);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    ssd1306_UpdateScreen();
+}
+
+/*
+ * Times 100 runs of each span primitive against the same shape drawn
+ * pixel by pixel: a full-screen rectangle, 32 horizontal lines (one per
+ * row) and 128 vertical lines (one per column)
+ */
+void ssd1306_TestSpanSpeed() {
+    uint32_t start;
+    uint32_t pixel_time[3];
+    uint32_t span_time[3];
+    char buff[24];
+    uint8_t i, x, y;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        for(y = 0; y < SSD1306_HEIGHT; y++) {
+            for(x = 0; x < SSD1306_WIDTH; x++) {
+                ssd1306_DrawPixel(x, y, (SSD1306_COLOR)(i & 1));
+            }
+        }
+    }
+    pixel_time[0] = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        ssd1306_FillRectangle(0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, (SSD1306_COLOR)(i & 1));
+    }
+    span_time[0] = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        for(y = 0; y < SSD1306_HEIGHT; y++) {
+            for(x = 0; x < SSD1306_WIDTH; x++) {
+                ssd1306_DrawPixel(x, y, (SSD1306_COLOR)((i ^ y) & 1));
+            }
+        }
+    }
+    pixel_time[1] = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        for(y = 0; y < SSD1306_HEIGHT; y++) {
+            ssd1306_DrawHLine(0, SSD1306_WIDTH - 1, y, (SSD1306_COLOR)((i ^ y) & 1));
+        }
+    }
+    span_time[1] = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        for(x = 0; x < SSD1306_WIDTH; x++) {
+            for(y = 0; y < SSD1306_HEIGHT; y++) {
+                ssd1306_DrawPixel(x, y, (SSD1306_COLOR)((i ^ x) & 1));
+            }
+        }
+    }
+    pixel_time[2] = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(i = 0; i < 100; i++) {
+        for(x = 0; x < SSD1306_WIDTH; x++) {
+            ssd1306_DrawVLine(x, 0, SSD1306_HEIGHT - 1, (SSD1306_COLOR)((i ^ x) & 1));
+        }
+    }
+    span_time[2] = HAL_GetTick() - start;
+
+    ssd1306_Fill(Black);
+    snprintf(buff, sizeof(buff), "rect:  %lu/%lums", (unsigned long)pixel_time[0], (unsigned long)span_time[0]);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "hline: %lu/%lums", (unsigned long)pixel_time[1], (unsigned long)span_time[1]);
+    ssd1306_SetCursor(2, 10);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "vline: %lu/%lums", (unsigned long)pixel_time[2], (unsigned long)span_time[2]);
+    ssd1306_SetCursor(2, 20);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    ssd1306_UpdateScreen();
+}
+
+/*
+ * Draw a sprite once in an off-screen target, then compare moving it over
+ * the screen by blitting with drawing it again at every position
+ */
+void ssd1306_TestRenderTarget() {
+    static uint8_t sprite_buffer[24 * 2];
+    static const SSD1306_Target_t sprite = { sprite_buffer, 24, 12 };
+    uint32_t start;
+    uint32_t draw_time, blit_time;
+    char buff[24];
+    uint8_t x;
+
+    ssd1306_SetTarget(&sprite);
+    ssd1306_Fill(Black);
+    ssd1306_DrawRectangle(0, 0, 23, 11, White);
+    ssd1306_SetCursor(3, 2);
+    ssd1306_WriteString("V:5", Font_6x8, White);
+    ssd1306_SetTarget(NULL);
+
+    start = HAL_GetTick();
+    for(x = 0; x < SSD1306_WIDTH - 24; x++) {
+        ssd1306_ClearRegion(0, 10, SSD1306_WIDTH - 1, 29);
+        ssd1306_DrawRectangle(x, 10 + x % 8, x + 23, 21 + x % 8, White);
+        ssd1306_SetCursor(x + 3, 12 + x % 8);
+        ssd1306_WriteString("V:5", Font_6x8, White);
+        ssd1306_UpdateScreen();
+    }
+    draw_time = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    for(x = 0; x < SSD1306_WIDTH - 24; x++) {
+        ssd1306_ClearRegion(0, 10, SSD1306_WIDTH - 1, 29);
+        ssd1306_BlitTarget(&sprite, x, 10 + x % 8);
+        ssd1306_UpdateScreen();
+    }
+    blit_time = HAL_GetTick() - start;
+
+    ssd1306_Fill(Black);
+    snprintf(buff, sizeof(buff), "draw: %lums", (unsigned long)draw_time);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    snprintf(buff, sizeof(buff), "blit: %lums", (unsigned long)blit_time);
+    ssd1306_SetCursor(2, 10);
+    ssd1306_WriteString(buff, Font_6x8, White);
+    ssd1306_UpdateScreen();
+}
+
 void ssd1306_TestPolyline() {
   SSD1306_VERTEX loc_vertex[] =
   {
@@ -316,11 +718,17 @@ void ssd1306_TestAll() {
 
     ssd1306_TestFPS();
     HAL_Delay(3000);
+    ssd1306_TestFPSProfiles();
+    HAL_Delay(5000);
+    ssd1306_TestFlushBytes();
+    HAL_Delay(3000);
     ssd1306_TestBorder();
     ssd1306_TestFonts1();
     HAL_Delay(3000);
     ssd1306_TestFonts2();
     HAL_Delay(3000);
+    ssd1306_TestTextSpeed();
+    HAL_Delay(3000);
     ssd1306_Fill(Black);
     ssd1306_TestRectangle();
     ssd1306_TestLine();
@@ -331,9 +739,15 @@ void ssd1306_TestAll() {
     ssd1306_Fill(Black);
     ssd1306_TestPolyline();
     HAL_Delay(3000);
+    ssd1306_TestSpanSpeed();
+    HAL_Delay(3000);
+    ssd1306_TestRenderTarget();
+    HAL_Delay(3000);
     ssd1306_Fill(Black);
     ssd1306_TestArc();
     HAL_Delay(3000);
+    ssd1306_TestArcSpeed();
+    HAL_Delay(3000);
     ssd1306_Fill(Black);
     ssd1306_TestCircle();
     HAL_Delay(3000);
@@ -341,3 +755,4 @@ void ssd1306_TestAll() {
     HAL_Delay(3000);
 }
 
+#endif // SSD1306_TESTS
@@ -5,15 +5,23 @@
 
 _BEGIN_STD_C
 
+// Built with -DSSD1306_TESTS only, see ssd1306_conf.h
 void ssd1306_TestBorder(void);
 void ssd1306_TestFonts(void);
+void ssd1306_TestTextSpeed(void);
 void ssd1306_TestFPS(void);
+uint32_t ssd1306_MeasureFPS(uint32_t duration_ms, uint32_t* bytes_per_s);
+void ssd1306_TestFPSProfiles(void);
+void ssd1306_TestFlushBytes(void);
 void ssd1306_TestAll(void);
 void ssd1306_TestLine(void);
 void ssd1306_TestRectangle(void);
 void ssd1306_TestRectangleFill();
+void ssd1306_TestSpanSpeed(void);
+void ssd1306_TestRenderTarget(void);
 void ssd1306_TestCircle(void);
 void ssd1306_TestArc(void);
+void ssd1306_TestArcSpeed(void);
 void ssd1306_TestPolyline(void);
 void ssd1306_TestDrawBitmap(void);
 
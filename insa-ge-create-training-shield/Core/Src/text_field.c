@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : text_field.c
+  * @brief          : Retained labelled value fields for the text screens
+  ******************************************************************************
+  */
+
+#include "text_field.h"
+#include <string.h>
+#include "fixed_format.h"
+#include "ssd1306/ssd1306.h"
+
+/**
+  * @brief  Forget what the screenbuffer holds, after it was cleared
+  * @note   The next update of each field draws its label and every cell
+  */
+void Text_Screen_Invalidate(const Text_Screen_t* screen)
+{
+    memset(screen->shown, 0, (size_t)screen->count * TEXT_FIELD_MAX_CHARS);
+}
+
+/**
+  * @brief  Show a value, drawing only the cells that changed
+  * @param  screen Screen the field belongs to
+  * @param  field Index of the field in the screen table
+  * @param  text Value, padded with blanks or cut to the field width
+  */
+void Text_Field_Set(const Text_Screen_t* screen, uint32_t field, const char* text)
+{
+    const Text_Field_Def_t* def;
+    char* shown;
+    uint8_t cell_x;
+    uint8_t i;
+
+    if (field >= screen->count) return;
+    def = &screen->fields[field];
+    shown = screen->shown[field];
+    cell_x = def->x;
+
+    // A zero cell means unknown content: cells always hold a character once drawn
+    if (shown[0] == '\0' && def->label != NULL) {
+        ssd1306_SetCursor(def->x, def->y);
+        ssd1306_WriteString((char*)def->label, *def->font, White);
+    }
+    if (def->label != NULL) {
+        cell_x += (uint8_t)(strlen(def->label) * def->font->FontWidth);
+    }
+
+    for (i = 0; i < def->width && i < TEXT_FIELD_MAX_CHARS; i++) {
+        char c = (*text != '\0') ? *text++ : ' ';
+
+        if (c != shown[i]) {
+            // Blanks and glyphs missing from the font clear the cell
+            ssd1306_SetCursor(cell_x, def->y);
+            if (c == ' ' || ssd1306_WriteChar(c, *def->font, White) != c) {
+                ssd1306_ClearRegion(cell_x, def->y,
+                                    cell_x + def->font->FontWidth - 1,
+                                    def->y + def->font->FontHeight - 1);
+            }
+            shown[i] = c;
+        }
+        cell_x += def->font->FontWidth;
+    }
+}
+
+/**
+  * @brief  Show a fixed-point value with the field layout, right-aligned before its unit
+  * @param  screen Screen the field belongs to
+  * @param  field Index of the field in the screen table
+  * @param  value Value in units of its last digit, see Format_From_Float
+  */
+void Text_Field_Set_Value(const Text_Screen_t* screen, uint8_t field, int32_t value)
+{
+    const Text_Field_Def_t* def;
+    char text[TEXT_FIELD_MAX_CHARS + 1];
+    Format_Buffer_t out;
+    uint8_t unit_width;
+
+    if (field >= screen->count) return;
+    def = &screen->fields[field];
+    unit_width = (def->unit != NULL) ? (uint8_t)strlen(def->unit) : 0;
+
+    Format_Begin(&out, text, sizeof(text));
+    Format_Fixed(&out, value, def->decimals, def->decimals,
+                 (def->width > unit_width) ? def->width - unit_width : 0, def->flags);
+    if (def->unit != NULL) {
+        Format_Text(&out, def->unit);
+    }
+    Text_Field_Set(screen, field, text);
+}
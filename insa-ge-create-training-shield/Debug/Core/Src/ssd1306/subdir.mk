@@ -7,16 +7,22 @@
 C_SRCS += \
 ../Core/Src/ssd1306/ssd1306.c \
 ../Core/Src/ssd1306/ssd1306_fonts.c \
+../Core/Src/ssd1306/ssd1306_fonts_subset.c \
+../Core/Src/ssd1306/ssd1306_icons.c \
 ../Core/Src/ssd1306/ssd1306_tests.c 
 
 OBJS += \
 ./Core/Src/ssd1306/ssd1306.o \
 ./Core/Src/ssd1306/ssd1306_fonts.o \
+./Core/Src/ssd1306/ssd1306_fonts_subset.o \
+./Core/Src/ssd1306/ssd1306_icons.o \
 ./Core/Src/ssd1306/ssd1306_tests.o 
 
 C_DEPS += \
 ./Core/Src/ssd1306/ssd1306.d \
 ./Core/Src/ssd1306/ssd1306_fonts.d \
+./Core/Src/ssd1306/ssd1306_fonts_subset.d \
+./Core/Src/ssd1306/ssd1306_icons.d \
 ./Core/Src/ssd1306/ssd1306_tests.d 
 
 
@@ -27,7 +33,7 @@ Core/Src/ssd1306/%.o Core/Src/ssd1306/%.su Core/Src/ssd1306/%.cyclo: ../Core/Src
 clean: clean-Core-2f-Src-2f-ssd1306
 
 clean-Core-2f-Src-2f-ssd1306:
-	-$(RM) ./Core/Src/ssd1306/ssd1306.cyclo ./Core/Src/ssd1306/ssd1306.d ./Core/Src/ssd1306/ssd1306.o ./Core/Src/ssd1306/ssd1306.su ./Core/Src/ssd1306/ssd1306_fonts.cyclo ./Core/Src/ssd1306/ssd1306_fonts.d ./Core/Src/ssd1306/ssd1306_fonts.o ./Core/Src/ssd1306/ssd1306_fonts.su ./Core/Src/ssd1306/ssd1306_tests.cyclo ./Core/Src/ssd1306/ssd1306_tests.d ./Core/Src/ssd1306/ssd1306_tests.o ./Core/Src/ssd1306/ssd1306_tests.su
+	-$(RM) ./Core/Src/ssd1306/ssd1306.cyclo ./Core/Src/ssd1306/ssd1306.d ./Core/Src/ssd1306/ssd1306.o ./Core/Src/ssd1306/ssd1306.su ./Core/Src/ssd1306/ssd1306_fonts.cyclo ./Core/Src/ssd1306/ssd1306_fonts.d ./Core/Src/ssd1306/ssd1306_fonts.o ./Core/Src/ssd1306/ssd1306_fonts.su ./Core/Src/ssd1306/ssd1306_fonts_subset.cyclo ./Core/Src/ssd1306/ssd1306_fonts_subset.d ./Core/Src/ssd1306/ssd1306_fonts_subset.o ./Core/Src/ssd1306/ssd1306_fonts_subset.su ./Core/Src/ssd1306/ssd1306_icons.cyclo ./Core/Src/ssd1306/ssd1306_icons.d ./Core/Src/ssd1306/ssd1306_icons.o ./Core/Src/ssd1306/ssd1306_icons.su ./Core/Src/ssd1306/ssd1306_tests.cyclo ./Core/Src/ssd1306/ssd1306_tests.d ./Core/Src/ssd1306/ssd1306_tests.o ./Core/Src/ssd1306/ssd1306_tests.su
 
 .PHONY: clean-Core-2f-Src-2f-ssd1306
 
@@ -5,28 +5,58 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Core/Src/fixed_format.c \
+../Core/Src/i2c_timing.c \
+../Core/Src/input_queue.c \
 ../Core/Src/main.c \
+../Core/Src/menu.c \
+../Core/Src/power_histogram.c \
+../Core/Src/power_history.c \
+../Core/Src/render_scheduler.c \
+../Core/Src/scope_capture.c \
+../Core/Src/screens.c \
 ../Core/Src/stm32l0xx_hal_msp.c \
 ../Core/Src/stm32l0xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32l0xx.c 
+../Core/Src/system_stm32l0xx.c \
+../Core/Src/text_field.c 
 
 OBJS += \
+./Core/Src/fixed_format.o \
+./Core/Src/i2c_timing.o \
+./Core/Src/input_queue.o \
 ./Core/Src/main.o \
+./Core/Src/menu.o \
+./Core/Src/power_histogram.o \
+./Core/Src/power_history.o \
+./Core/Src/render_scheduler.o \
+./Core/Src/scope_capture.o \
+./Core/Src/screens.o \
 ./Core/Src/stm32l0xx_hal_msp.o \
 ./Core/Src/stm32l0xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32l0xx.o 
+./Core/Src/system_stm32l0xx.o \
+./Core/Src/text_field.o 
 
 C_DEPS += \
+./Core/Src/fixed_format.d \
+./Core/Src/i2c_timing.d \
+./Core/Src/input_queue.d \
 ./Core/Src/main.d \
+./Core/Src/menu.d \
+./Core/Src/power_histogram.d \
+./Core/Src/power_history.d \
+./Core/Src/render_scheduler.d \
+./Core/Src/scope_capture.d \
+./Core/Src/screens.d \
 ./Core/Src/stm32l0xx_hal_msp.d \
 ./Core/Src/stm32l0xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32l0xx.d 
+./Core/Src/system_stm32l0xx.d \
+./Core/Src/text_field.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -36,7 +66,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32l0xx_hal_msp.cyclo ./Core/Src/stm32l0xx_hal_msp.d ./Core/Src/stm32l0xx_hal_msp.o ./Core/Src/stm32l0xx_hal_msp.su ./Core/Src/stm32l0xx_it.cyclo ./Core/Src/stm32l0xx_it.d ./Core/Src/stm32l0xx_it.o ./Core/Src/stm32l0xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32l0xx.cyclo ./Core/Src/system_stm32l0xx.d ./Core/Src/system_stm32l0xx.o ./Core/Src/system_stm32l0xx.su
+	-$(RM) ./Core/Src/fixed_format.cyclo ./Core/Src/fixed_format.d ./Core/Src/fixed_format.o ./Core/Src/fixed_format.su ./Core/Src/i2c_timing.cyclo ./Core/Src/i2c_timing.d ./Core/Src/i2c_timing.o ./Core/Src/i2c_timing.su ./Core/Src/input_queue.cyclo ./Core/Src/input_queue.d ./Core/Src/input_queue.o ./Core/Src/input_queue.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/menu.cyclo ./Core/Src/menu.d ./Core/Src/menu.o ./Core/Src/menu.su ./Core/Src/power_histogram.cyclo ./Core/Src/power_histogram.d ./Core/Src/power_histogram.o ./Core/Src/power_histogram.su ./Core/Src/power_history.cyclo ./Core/Src/power_history.d ./Core/Src/power_history.o ./Core/Src/power_history.su ./Core/Src/render_scheduler.cyclo ./Core/Src/render_scheduler.d ./Core/Src/render_scheduler.o ./Core/Src/render_scheduler.su ./Core/Src/scope_capture.cyclo ./Core/Src/scope_capture.d ./Core/Src/scope_capture.o ./Core/Src/scope_capture.su ./Core/Src/screens.cyclo ./Core/Src/screens.d ./Core/Src/screens.o ./Core/Src/screens.su ./Core/Src/stm32l0xx_hal_msp.cyclo ./Core/Src/stm32l0xx_hal_msp.d ./Core/Src/stm32l0xx_hal_msp.o ./Core/Src/stm32l0xx_hal_msp.su ./Core/Src/stm32l0xx_it.cyclo ./Core/Src/stm32l0xx_it.d ./Core/Src/stm32l0xx_it.o ./Core/Src/stm32l0xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32l0xx.cyclo ./Core/Src/system_stm32l0xx.d ./Core/Src/system_stm32l0xx.o ./Core/Src/system_stm32l0xx.su ./Core/Src/text_field.cyclo ./Core/Src/text_field.d ./Core/Src/text_field.o ./Core/Src/text_field.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -0,0 +1,164 @@
+/*
+ * Host check of the fixed-point formatter.
+ *
+ * Formats values with Format_Fixed, the same fixed_format.c as the
+ * firmware, and compares the text with glibc printf of the same value.
+ *
+ *   check [N]           compare N random values (default 200000) over
+ *                       every scale, decimals, flags and widths 0-20
+ *   check --bench N     time N formats against snprintf
+ *
+ * The reference rounds the value half away from zero with integer
+ * arithmetic and lets printf format the exact result, so exact ties go
+ * the way the formatter rounds them. The one intended difference from
+ * printf, a negative value rounding to zero printed without its sign, is
+ * built into the reference.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fixed_format.h"
+
+#define CHECK_MAX_WIDTH     20
+
+static const uint64_t check_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL
+};
+
+static uint32_t check_seed = 2463534242UL;
+
+/* Reproducible xorshift, the runs compare across builds */
+static uint32_t check_random(void) {
+    check_seed ^= check_seed << 13;
+    check_seed ^= check_seed >> 17;
+    check_seed ^= check_seed << 5;
+    return check_seed;
+}
+
+/* Values of every length, ties of every scale and the 32-bit limits */
+static int32_t check_value(uint32_t n) {
+    uint32_t magnitude;
+
+    switch (n % 4) {
+    case 0:
+        return (int32_t)check_random();
+    case 1:
+        magnitude = check_random() % (uint32_t)check_pow10[1 + check_random() % 9];
+        break;
+    case 2:
+        // An exact tie: ...5 followed by zeros
+        magnitude = (check_random() % 100000u) * (uint32_t)check_pow10[1 + check_random() % 4];
+        magnitude += (uint32_t)check_pow10[check_random() % 5] * 5u;
+        break;
+    default: {
+        static const int32_t limits[] = { 0, 1, -1, 5, -5, 49, -50, INT32_MAX, INT32_MIN, INT32_MIN + 1 };
+
+        return limits[(n / 4) % (sizeof(limits) / sizeof(limits[0]))];
+    }
+    }
+    return (check_random() & 1) ? -(int32_t)magnitude : (int32_t)magnitude;
+}
+
+static void check_reference(char* text, size_t size, int32_t value, uint8_t scale, uint8_t decimals,
+                            uint8_t width, uint8_t flags) {
+    uint64_t magnitude = (value < 0) ? (uint64_t)(-(int64_t)value) : (uint64_t)value;
+    char format[16];
+    char* f = format;
+    long double shown;
+
+    if (decimals < scale) {
+        uint64_t step = check_pow10[scale - decimals];
+
+        magnitude = (magnitude + step / 2) / step;
+    } else {
+        magnitude *= check_pow10[decimals - scale];
+    }
+    // Exact to well below half a unit of the last digit with a 64-bit mantissa
+    shown = (long double)magnitude / (long double)check_pow10[decimals];
+    if (value < 0 && magnitude != 0) {
+        shown = -shown;
+    }
+
+    *f++ = '%';
+    if (flags & FORMAT_LEFT) *f++ = '-';
+    if (flags & FORMAT_PLUS) *f++ = '+';
+    if (flags & FORMAT_ZERO_PAD) *f++ = '0';
+    strcpy(f, "*.*Lf");
+    snprintf(text, size, format, (int)width, (int)decimals, shown);
+}
+
+static long check_sweep(long count) {
+    long cases = 0;
+    long failures = 0;
+
+    for (long n = 0; n < count; n++) {
+        int32_t value = check_value((uint32_t)n);
+
+        for (uint8_t scale = 0; scale <= FORMAT_MAX_DECIMALS; scale++) {
+            for (uint8_t decimals = 0; decimals <= FORMAT_MAX_DECIMALS; decimals++) {
+                uint8_t flags = check_random() % 8;
+                uint8_t width = check_random() % (CHECK_MAX_WIDTH + 1);
+                char expected[48];
+                char text[48];
+                Format_Buffer_t out;
+
+                Format_Begin(&out, text, sizeof(text));
+                Format_Fixed(&out, value, scale, decimals, width, flags);
+                check_reference(expected, sizeof(expected), value, scale, decimals, width, flags);
+                cases++;
+
+                if (strcmp(text, expected) != 0 || out.length != strlen(expected)) {
+                    if (failures++ < 20) {
+                        printf("FAIL %ld scale %u decimals %u width %u flags %u: \"%s\", printf \"%s\"\n",
+                               (long)value, scale, decimals, width, flags, text, expected);
+                    }
+                }
+            }
+        }
+    }
+    printf("%ld cases, %ld mismatches\n", cases, failures);
+    return failures;
+}
+
+/* The meter line "V:12.3V" as the firmware builds it, then with snprintf */
+static void check_bench(long count) {
+    static volatile int32_t millivolts = 12345;
+    char text[24];
+    Format_Buffer_t out;
+    clock_t start;
+    double fixed;
+    double printf_ns;
+
+    start = clock();
+    for (long n = 0; n < count; n++) {
+        Format_Begin(&out, text, sizeof(text));
+        Format_Text(&out, "V:");
+        Format_Fixed(&out, millivolts, 3, 1, 0, 0);
+        Format_Char(&out, 'V');
+    }
+    fixed = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count;
+
+    start = clock();
+    for (long n = 0; n < count; n++) {
+        snprintf(text, sizeof(text), "V:%.1fV", millivolts / 1000.0f);
+    }
+    printf_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count;
+
+    printf("Format_Fixed %8.1f ns/line\n", fixed);
+    printf("snprintf     %8.1f ns/line\n", printf_ns);
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && !strcmp(argv[1], "--bench")) {
+        check_bench(strtol(argv[2], NULL, 10));
+        return 0;
+    }
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: %s [N] | --bench N\n", argv[0]);
+        return 2;
+    }
+    return check_sweep(argc == 2 ? strtol(argv[1], NULL, 10) : 200000) ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Generate subset fonts for the SSD1306 library.
+
+Reads the full ASCII tables of Core/Src/ssd1306/ssd1306_fonts.c and keeps
+only the characters the firmware can print: every character of the string
+and character literals of the scanned sources, the digits and the signs
+produced by number formatting, and any extra characters given with
+--chars. Each subset font gets an index map from ASCII to glyph number.
+
+Writes ssd1306_fonts_subset.c/.h next to the full fonts; they are used
+when SSD1306_USE_FONT_SUBSET is defined in ssd1306_conf.h. Run it from
+the project directory after changing the strings shown on screen:
+
+    python Tools/font_subset.py
+    python Tools/font_subset.py --font 6x8 --chars "%+" Core/Src/main.c
+
+By default the application sources listed in Debug/objects.list are
+scanned; the ssd1306 tests are built with -DSSD1306_TESTS and print with
+the full fonts.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+FONT_DIR = os.path.join("Core", "Src", "ssd1306")
+FIRST_CHAR = 32
+CHAR_COUNT = 95
+MISSING = 0xFF
+
+# Always available: formatted numbers and blank padding
+NUMBER_CHARS = "0123456789-. "
+
+FONT_TABLE = re.compile(r"static const uint8_t Font(\d+)x(\d+) \[\] = \{\n(.*?)\n\};", re.S)
+STRING_LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+CHAR_LITERAL = re.compile(r"'((?:[^'\\\n]|\\.))'")
+FONT_USE = re.compile(r"\bFont_(\d+x\d+)\b")
+COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/", re.S)
+INCLUDE = re.compile(r"^[ \t]*#[ \t]*include[^\n]*", re.M)
+
+
+def load_fonts(path):
+    """Return {"6x8": (width, height, [glyph bytes, ...]), ...}"""
+    fonts = {}
+    with open(path) as f:
+        source = f.read()
+    for match in FONT_TABLE.finditer(source):
+        width, height = int(match.group(1)), int(match.group(2))
+        body = COMMENT.sub("", match.group(3))
+        data = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]+", body)]
+        size = width * ((height + 7) // 8)
+        if len(data) != size * CHAR_COUNT:
+            sys.exit("Font%dx%d: unexpected table size %d" % (width, height, len(data)))
+        fonts["%dx%d" % (width, height)] = (width, height, [data[i:i + size] for i in range(0, len(data), size)])
+    return fonts
+
+
+def scan_sources(paths):
+    """Characters of the literals in the sources, and the fonts they use"""
+    chars = set()
+    used = set()
+    for path in paths:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            source = INCLUDE.sub("", COMMENT.sub("", f.read()))
+        for literal in STRING_LITERAL.findall(source) + CHAR_LITERAL.findall(source):
+            # Format directives print numbers, covered by NUMBER_CHARS
+            literal = re.sub(r"%[-+ #0]*\d*(?:\.\d+)?(?:l|ll|h)?[diuxXcsf%]", "", literal)
+            literal = re.sub(r"\\.", "", literal)
+            chars.update(c for c in literal if FIRST_CHAR <= ord(c) < FIRST_CHAR + CHAR_COUNT)
+        used.update(FONT_USE.findall(source))
+    return chars, used
+
+
+def application_sources():
+    """Sources of Core/Src linked by the Debug build, the display library excluded"""
+    sources = []
+    with open(os.path.join("Debug", "objects.list")) as f:
+        for line in f:
+            match = re.match(r'"\./(Core/Src/[^/]+)\.o"', line.strip())
+            if match:
+                sources.append(match.group(1).replace("/", os.sep) + ".c")
+    return sources
+
+
+def format_bytes(values, indent=""):
+    lines = []
+    for i in range(0, len(values), 16):
+        lines.append(indent + ", ".join("0x%02X" % v for v in values[i:i + 16]) + ",")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("sources", nargs="*",
+                        help="sources whose strings must be printable (default: application sources of the build)")
+    parser.add_argument("--font", action="append", help="font to subset, e.g. 6x8 (default: fonts used by the sources)")
+    parser.add_argument("--chars", default="", help="extra characters to keep")
+    args = parser.parse_args()
+
+    fonts = load_fonts(os.path.join(FONT_DIR, "ssd1306_fonts.c"))
+    chars, used = scan_sources(args.sources or application_sources())
+    chars.update(NUMBER_CHARS)
+    chars.update(args.chars)
+    charset = "".join(sorted(chars))
+    selected = args.font or sorted(used, key=lambda name: fonts.get(name, (0, 0))[:2])
+
+    source = ["/*",
+              " * Subset fonts generated by Tools/font_subset.py, do not edit.",
+              " * Characters: %s" % charset.replace("*/", "* /"),
+              " */",
+              "",
+              '#include "ssd1306_fonts.h"',
+              "",
+              "#ifdef SSD1306_USE_FONT_SUBSET",
+              ""]
+    header = ["/*",
+              " * Subset fonts generated by Tools/font_subset.py, do not edit.",
+              " * Fonts listed here replace the full tables of ssd1306_fonts.c",
+              " */",
+              "",
+              "#ifndef __SSD1306_FONTS_SUBSET_H__",
+              "#define __SSD1306_FONTS_SUBSET_H__",
+              ""]
+    saved = 0
+    for name in selected:
+        if name not in fonts:
+            sys.exit("Unknown font %s" % name)
+        width, height, glyphs = fonts[name]
+        index_map = [MISSING] * CHAR_COUNT
+        kept = []
+        for c in charset:
+            index_map[ord(c) - FIRST_CHAR] = len(kept)
+            kept.append(glyphs[ord(c) - FIRST_CHAR])
+        full_size = sum(len(g) for g in glyphs)
+        subset_size = sum(len(g) for g in kept) + CHAR_COUNT
+        saved += full_size - subset_size
+        print("Font_%s: %d of %d glyphs, %d -> %d bytes" % (name, len(kept), CHAR_COUNT, full_size, subset_size))
+
+        header.append("#define SSD1306_SUBSET_FONT_%s" % name)
+        source.append("#ifdef SSD1306_INCLUDE_FONT_%s" % name)
+        source.append("static const uint8_t Font%s_Subset [] = {" % name)
+        for c, glyph in zip(charset, kept):
+            label = "sp" if c == " " else c
+            lines = format_bytes(glyph)
+            lines[0] += "  // %s" % label
+            source.extend(lines)
+        source.append("};")
+        source.append("")
+        source.append("static const uint8_t Font%s_Map [] = {" % name)
+        source.extend(format_bytes(index_map))
+        source.append("};")
+        source.append("")
+        source.append("FontDef Font_%s = {%d,%d,Font%s_Subset,Font%s_Map};" % (name, width, height, name, name))
+        source.append("#endif")
+        source.append("")
+
+    source.insert(3, " * Flash saved against the full fonts: %d bytes" % saved)
+    source.append("#endif // SSD1306_USE_FONT_SUBSET")
+    header.append("")
+    header.append("#endif // __SSD1306_FONTS_SUBSET_H__")
+
+    with open(os.path.join(FONT_DIR, "ssd1306_fonts_subset.c"), "w", newline="\n") as f:
+        f.write("\n".join(source) + "\n")
+    with open(os.path.join(FONT_DIR, "ssd1306_fonts_subset.h"), "w", newline="\n") as f:
+        f.write("\n".join(header) + "\n")
+    print("%d bytes of flash saved" % saved)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Generate the icon atlas of the SSD1306 library.
+
+Reads the icons drawn in Tools/icons.txt and stores them page-native, the
+layout of the display buffer and of the fonts: for each page of 8 rows,
+one byte per column with the top row in bit 0. ssd1306_DrawIcon merges
+these bytes into the buffer without going through single pixels.
+
+Icons that get smaller with run-length encoding are stored encoded: a
+control byte 0x80 | (n - 1) followed by one byte repeated n times, or
+n - 1 followed by n literal bytes.
+
+Writes ssd1306_icons.c/.h next to the fonts. Run it from the project
+directory after changing the icons:
+
+    python Tools/icon_atlas.py
+    python Tools/icon_atlas.py --no-rle
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ICON_DIR = os.path.join("Core", "Src", "ssd1306")
+ICON_FILE = os.path.join("Tools", "icons.txt")
+MAX_SIZE = 255
+MIN_RUN = 3
+MAX_BLOCK = 128
+
+
+def load_icons(path):
+    """Return [(name, ["..##..", ...]), ...] in file order"""
+    icons = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.rstrip()
+            if not line or line == "#" or line.startswith("# "):
+                continue
+            match = re.match(r"icon\s+([A-Za-z_]\w*)$", line)
+            if match:
+                icons.append((match.group(1), []))
+            elif not icons or re.search(r"[^#.]", line):
+                sys.exit("%s:%d: expected an icon name or a row of '#' and '.'" % (path, number))
+            else:
+                icons[-1][1].append(line)
+    for name, rows in icons:
+        if not rows or any(len(row) != len(rows[0]) for row in rows):
+            sys.exit("%s: icon %s needs rows of the same width" % (path, name))
+        if len(rows[0]) > MAX_SIZE or len(rows) > MAX_SIZE:
+            sys.exit("%s: icon %s is larger than %d pixels" % (path, name, MAX_SIZE))
+    return icons
+
+
+def page_bytes(rows):
+    """Column bytes of each page, top page first"""
+    data = []
+    for page in range(0, len(rows), 8):
+        for x in range(len(rows[0])):
+            value = 0
+            for bit, row in enumerate(rows[page:page + 8]):
+                if row[x] == "#":
+                    value |= 1 << bit
+            data.append(value)
+    return data
+
+
+def rle_encode(data):
+    encoded = []
+    literal = []
+
+    def flush_literal():
+        while literal:
+            block = literal[:MAX_BLOCK]
+            del literal[:MAX_BLOCK]
+            encoded.append(len(block) - 1)
+            encoded.extend(block)
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < MAX_BLOCK:
+            run += 1
+        if run >= MIN_RUN:
+            flush_literal()
+            encoded.extend([0x80 | (run - 1), data[i]])
+        else:
+            literal.extend(data[i:i + run])
+        i += run
+    flush_literal()
+    return encoded
+
+
+def rle_decode(encoded):
+    data = []
+    i = 0
+    while i < len(encoded):
+        count = (encoded[i] & 0x7F) + 1
+        if encoded[i] & 0x80:
+            data.extend([encoded[i + 1]] * count)
+            i += 2
+        else:
+            data.extend(encoded[i + 1:i + 1 + count])
+            i += 1 + count
+    return data
+
+
+def format_bytes(values, indent=""):
+    lines = []
+    for i in range(0, len(values), 16):
+        lines.append(indent + ", ".join("0x%02X" % v for v in values[i:i + 16]) + ",")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("icons", nargs="?", default=ICON_FILE, help="icon drawings (default: %s)" % ICON_FILE)
+    parser.add_argument("--no-rle", action="store_true", help="store every icon unencoded")
+    args = parser.parse_args()
+
+    icons = load_icons(args.icons)
+    source = ["/*",
+              " * Icon atlas generated by Tools/icon_atlas.py from %s, do not edit." % args.icons.replace(os.sep, "/"),
+              " */",
+              "",
+              '#include "ssd1306_icons.h"',
+              ""]
+    header = ["/*",
+              " * Icon atlas generated by Tools/icon_atlas.py, do not edit.",
+              " * Draw the icons with ssd1306_DrawIcon",
+              " */",
+              "",
+              "#ifndef __SSD1306_ICONS_H__",
+              "#define __SSD1306_ICONS_H__",
+              "",
+              '#include "ssd1306.h"',
+              ""]
+    total = 0
+    for name, rows in icons:
+        data = page_bytes(rows)
+        encoded = rle_encode(data)
+        if rle_decode(encoded) != data:
+            sys.exit("Icon %s: RLE round trip failed" % name)
+        rle = not args.no_rle and len(encoded) < len(data)
+        stored = encoded if rle else data
+        total += len(stored)
+        print("Icon_%s: %dx%d, %d bytes%s" % (name, len(rows[0]), len(rows), len(stored),
+                                             " (RLE, %d raw)" % len(data) if rle else ""))
+
+        header.append("extern const SSD1306_Icon_t Icon_%s;" % name)
+        source.append("static const uint8_t Icon%s_Data [] = {" % name)
+        source.extend(format_bytes(stored))
+        source.append("};")
+        source.append("const SSD1306_Icon_t Icon_%s = {%d,%d,%d,Icon%s_Data};" % (name, len(rows[0]), len(rows),
+                                                                               int(rle), name))
+        source.append("")
+
+    header.append("")
+    header.append("#endif // __SSD1306_ICONS_H__")
+
+    with open(os.path.join(ICON_DIR, "ssd1306_icons.c"), "w", newline="\n") as f:
+        f.write("\n".join(source))
+    with open(os.path.join(ICON_DIR, "ssd1306_icons.h"), "w", newline="\n") as f:
+        f.write("\n".join(header) + "\n")
+    print("%d icons, %d bytes of flash" % (len(icons), total))
+
+
+if __name__ == "__main__":
+    main()
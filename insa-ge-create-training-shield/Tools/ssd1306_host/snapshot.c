@@ -0,0 +1,783 @@
+/*
+ * Host build of the SSD1306 drawing code.
+ *
+ * Renders a set of scenes with the same ssd1306.c, fonts, menu engine and
+ * screens as the firmware and writes each one as a PBM image (lit pixels
+ * are white). Every screen of the menu has its scene, drawn by
+ * Display_Current_Menu from screens.c with the fixed measurements below.
+ *
+ *   snapshot [-o DIR]       write DIR/<scene>.pbm (default: out) and the
+ *                           bytes flushed by some screens to DIR/flush.txt
+ *   snapshot --check DIR    compare both with the golden files in DIR
+ *
+ * Both also draw the settings list while encoder interrupts fire in the
+ * middle of its frames, and fail if a flushed frame is half old
+ * selection and half new.
+ *
+ *   snapshot --bench N      time N renders of each scene, then the circle,
+ *                           arc, fill and text primitives against the
+ *                           previous ones
+ *
+ * PBM files open in most image viewers; `pnmtopng` or ImageMagick
+ * `convert` turn them into PNG.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "ssd1306_fonts.h"
+#include "ssd1306_icons.h"
+#include "menu.h"
+#include "main.h"
+#include "screens.h"
+#include "power_history.h"
+#include "power_histogram.h"
+#include "scope_capture.h"
+#include "input_queue.h"
+
+I2C_HandleTypeDef hi2c1;
+
+/* Simulated bus: every write completes at once */
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)DevAddress; (void)MemAddress; (void)MemAddSize; (void)pData; (void)Timeout;
+    hi2c->bytes += Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                        uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    (void)DevAddress; (void)MemAddress; (void)MemAddSize; (void)pData;
+    hi2c->bytes += Size;
+    ssd1306_TransferCompleteCallback();
+    return HAL_OK;
+}
+
+/* Fixed time, the screens showing ages render the same on every run */
+uint32_t HAL_GetTick(void) {
+    return HISTORY_DEPTH * HISTORY_BASE_PERIOD_MS;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    (void)Delay;
+}
+
+/* Text in every font the firmware uses */
+static void scene_fonts(void) {
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("Font 6x8: V I P", Font_6x8, White);
+    ssd1306_SetCursor(0, 8);
+    ssd1306_WriteString("V:12.3V I:1.25A", Font_7x10, White);
+    ssd1306_SetCursor(0, 16);
+    ssd1306_WriteString("12.3V", Font_Digits_11x16, White);
+    ssd1306_SetCursor(64, 18);
+    ssd1306_WriteString("Black", Font_6x8, Black);
+}
+
+/* Lines, rectangles, circles and arcs, some of them clipped */
+static void scene_shapes(void) {
+    ssd1306_Fill(Black);
+    ssd1306_DrawRectangle(0, 0, 127, 31, White);
+    ssd1306_FillRectangle(4, 3, 20, 13, White);
+    ssd1306_ClearRegion(8, 6, 16, 10);
+    ssd1306_Line(4, 28, 40, 16, White);
+    ssd1306_DrawCircle(56, 16, 11, White);
+    ssd1306_FillCircle(56, 16, 5, White);
+    ssd1306_DrawArc(92, 24, 18, 90, 180, White);
+    ssd1306_DrawRadiusLine(92, 24, 4, 16, 135, White);
+    ssd1306_FillCircle(124, 2, 6, White);
+}
+
+/* A sprite drawn once off-screen, then blitted at rows off the page grid */
+static void scene_sprite(void) {
+    static uint8_t sprite_buffer[16 * 2];
+    static const SSD1306_Target_t sprite = { sprite_buffer, 16, 12 };
+
+    ssd1306_SetTarget(&sprite);
+    ssd1306_Fill(Black);
+    ssd1306_DrawRectangle(0, 0, 15, 11, White);
+    ssd1306_Line(0, 0, 15, 11, White);
+    ssd1306_Line(0, 11, 15, 0, White);
+    ssd1306_SetTarget(NULL);
+
+    ssd1306_Fill(Black);
+    for (uint8_t i = 0; i < 8; i++) {
+        ssd1306_BlitTarget(&sprite, i * 17, i * 3);
+    }
+}
+
+/* Every icon of the atlas in each mode, on and off the page grid, over a pattern */
+static void scene_icons(void) {
+    static const SSD1306_Icon_t* const icons[] = {
+        &Icon_Alarm, &Icon_Logging, &Icon_Link, &Icon_Battery, &Icon_Calibration
+    };
+    uint8_t x = 0;
+
+    ssd1306_Fill(Black);
+    ssd1306_FillRectangle(0, 16, 127, 23, White);
+    for (uint8_t i = 0; i < sizeof(icons) / sizeof(icons[0]); i++) {
+        ssd1306_DrawIcon(x, 0, icons[i], SSD1306_ICON_OPAQUE);
+        ssd1306_DrawIcon(x, 11, icons[i], SSD1306_ICON_SET);
+        ssd1306_DrawIcon(x, 20, icons[i], SSD1306_ICON_XOR);
+        ssd1306_DrawIcon(x, 14, icons[i], SSD1306_ICON_CLEAR);
+        x += icons[i]->width + 3;
+    }
+    ssd1306_DrawIcon(122, 28, &Icon_Battery, SSD1306_ICON_OPAQUE);
+}
+
+/* Inputs of the firmware screens, the values main.c would have measured */
+float simulated_voltage = 12.3f;
+float simulated_current = 1.25f;
+float simulated_power = 15.375f;
+float accumulated_energy = 2.5f;
+float peak_voltage = 28.4f;
+float peak_current = 4.87f;
+float peak_power = 121.3f;
+uint8_t rotary_counter = 7;
+uint8_t button_state;
+I2C_Profile_t i2c_requested_profile = I2C_PROFILE_DEFAULT;
+Display_Recovery_Log_t display_recovery_log = { 1, 0, 5000, 12, 12, 12 };
+
+/* Same scaling as main.c */
+float Convert_ADC_to_Voltage(uint32_t adc_value) {
+    return (float)adc_value * 30.0f / 4095.0f;
+}
+
+float Convert_ADC_to_Current(uint32_t adc_value) {
+    return (float)adc_value * 5.0f / 4095.0f;
+}
+
+/* The scenes never run the reset items, the inputs stay fixed */
+void Reset_Peaks(void) {
+}
+
+void Reset_Energy(void) {
+}
+
+uint8_t Button_Held_For_Turn(void) {
+    return button_state;
+}
+
+static void frame_interrupt(void);
+
+/* Drawn in the middle of the settings list, where frame_check fires its interrupt */
+const char* I2C_Timing_Get_Name(I2C_Profile_t profile) {
+    static const char* const names[I2C_PROFILE_COUNT] = { "100k", "400k", "1M" };
+
+    frame_interrupt();
+    return (profile < I2C_PROFILE_COUNT) ? names[profile] : "?";
+}
+
+/* Graph history, power distribution and a frozen scope capture, from triangle waves */
+static void host_record_inputs(void) {
+    for (uint32_t n = 0; n < HISTORY_DEPTH + 20; n++) {
+        uint32_t phase = n % 40;
+        float voltage = 6.0f + 0.5f * (float)((phase < 20) ? phase : 40 - phase);
+        float current = 0.5f + 0.1f * (float)(n % 25);
+
+        History_Push(voltage, current, voltage * current, n * HISTORY_BASE_PERIOD_MS);
+    }
+    for (uint32_t n = 0; n < 1000; n++) {
+        Histogram_Add((float)(n % 50 + n % 70));
+    }
+
+    Scope_Arm();
+    for (uint32_t n = 0; n < 4 * SCOPE_DEPTH && Scope_Get_State() != SCOPE_DONE; n++) {
+        uint32_t phase = n % 64;
+        uint16_t wave = (uint16_t)(((phase < 32) ? phase : 64 - phase) * (SCOPE_ADC_FULL_SCALE / 32));
+
+        Scope_Add_Sample(SCOPE_ADC_FULL_SCALE - wave, wave);
+    }
+}
+
+static uint8_t host_main_selection = 2;
+
+/* A firmware screen as the menu reaches it, drawn by the firmware entry point */
+static void host_show(uint8_t screen, uint8_t selection) {
+    Screens_Init();
+    Menu_Set_Screen(screen, selection);
+    Screens_Invalidate();
+    Display_Current_Menu();
+}
+
+/* The power meter view reached by short presses, in the order they cycle */
+static void host_power_meter(uint8_t view) {
+    static uint8_t shown;
+
+    Screens_Init();
+    while (shown != view) {
+        Menu_Press();
+        shown = (shown + 1) % 3;
+    }
+    Screens_Invalidate();
+    Display_Current_Menu();
+}
+
+static void scene_power_meter(void) { host_power_meter(0); }
+static void scene_gauge(void) { host_power_meter(1); }
+static void scene_big_numbers(void) { host_power_meter(2); }
+static void scene_main(void) { host_show(MENU_MAIN, host_main_selection); }
+static void scene_peaks(void) { host_show(MENU_PEAKS, 0); }
+static void scene_reset(void) { host_show(MENU_RESET, 1); }
+static void scene_about(void) { host_show(MENU_ABOUT, 0); }
+static void scene_histogram(void) { host_show(MENU_HISTOGRAM, 0); }
+static void scene_scope(void) { host_show(MENU_SCOPE, 0); }
+static void scene_scope_settings(void) { host_show(MENU_SCOPE_SETTINGS, 1); }
+static void scene_diagnostics(void) { host_show(MENU_DIAGNOSTICS, 3); }
+
+/* Power graph opened from its item of the graphics list */
+static void scene_graphics(void) {
+    Screens_Init();
+    Menu_Set_Screen(MENU_GRAPHICS_SELECT, 2);
+    Menu_Press();
+    Display_Current_Menu();
+}
+
+/* A long list scrolled back from the first item, which wraps to Back */
+static void scene_graphics_select(void) {
+    Screens_Init();
+    Menu_Set_Screen(MENU_GRAPHICS_SELECT, 0);
+    Menu_Turn(-1);
+    Menu_Turn(-1);
+    Menu_Turn(-1);
+    Display_Current_Menu();
+}
+
+/* A Back item returns to its parent with the item that opened the list selected */
+static void scene_settings(void) {
+    Screens_Init();
+    Menu_Set_Screen(MENU_SCOPE_SETTINGS, 3);
+    Menu_Press();
+    Display_Current_Menu();
+}
+
+/* Outline and filled circles of several radii, clipped ones, and arcs off the 10 degree grid */
+static void scene_circles(void) {
+    ssd1306_Fill(Black);
+    for (uint8_t r = 0; r <= 15; r += 3) {
+        ssd1306_DrawCircle(16, 16, r, White);
+    }
+    ssd1306_FillCircle(44, 16, 9, White);
+    ssd1306_FillCircle(44, 16, 4, Black);
+    ssd1306_DrawCircle(2, 30, 6, White);
+    ssd1306_FillCircle(126, 0, 7, White);
+    ssd1306_DrawArc(90, 31, 28, 90, 270, White);
+    ssd1306_DrawArcWithRadiusLine(90, 16, 12, 37, 113, White);
+    ssd1306_DrawArc(90, 16, 6, 200, 5, White);
+}
+
+typedef struct {
+    const char* name;
+    void (*render)(void);
+} Scene_t;
+
+static const Scene_t scenes[] = {
+    { "fonts", scene_fonts },
+    { "shapes", scene_shapes },
+    { "circles", scene_circles },
+    { "sprite", scene_sprite },
+    { "icons", scene_icons },
+    { "power_meter", scene_power_meter },
+    { "gauge", scene_gauge },
+    { "big_numbers", scene_big_numbers },
+    { "main", scene_main },
+    { "peaks", scene_peaks },
+    { "graphics", scene_graphics },
+    { "graphics_select", scene_graphics_select },
+    { "settings", scene_settings },
+    { "reset", scene_reset },
+    { "about", scene_about },
+    { "histogram", scene_histogram },
+    { "scope", scene_scope },
+    { "scope_settings", scene_scope_settings },
+    { "diagnostics", scene_diagnostics },
+};
+#define SCENE_COUNT (sizeof(scenes) / sizeof(scenes[0]))
+
+/* Swap an input with another value, a second call puts it back */
+static void host_swap(float* value, float* other) {
+    float kept = *value;
+
+    *value = *other;
+    *other = kept;
+}
+
+static void change_voltage(void) {
+    static float other = 12.9f;
+
+    host_swap(&simulated_voltage, &other);
+}
+
+static void change_peak(void) {
+    static float other = 121.4f;
+
+    host_swap(&peak_power, &other);
+}
+
+static void change_selection(void) {
+    host_main_selection ^= 1;
+}
+
+static void change_recoveries(void) {
+    display_recovery_log.count ^= 3;
+}
+
+typedef struct {
+    const char* name;
+    void (*render)(void);
+    void (*change)(void);   // One field of the screen, undone by a second call
+} Flush_Case_t;
+
+static const Flush_Case_t flush_cases[] = {
+    { "power_meter", scene_power_meter, change_voltage },
+    { "gauge", scene_gauge, change_voltage },
+    { "big_numbers", scene_big_numbers, change_voltage },
+    { "main", scene_main, change_selection },
+    { "peaks", scene_peaks, change_peak },
+    { "diagnostics", scene_diagnostics, change_recoveries },
+};
+#define FLUSH_CASE_COUNT (sizeof(flush_cases) / sizeof(flush_cases[0]))
+
+/* Bytes written to the simulated display by one flush */
+static uint32_t flush_bytes(void) {
+    uint32_t start = hi2c1.bytes;
+
+    ssd1306_UpdateScreen();
+    return hi2c1.bytes - start;
+}
+
+/*
+ * Flush each screen as a full frame, then with one field changed, and
+ * write the bytes of both to DIR/flush.txt or compare them with it. The
+ * second frame only sends the dirty span of the field
+ */
+static int flush_check(const char* dir, int check) {
+    char path[512];
+    char expected[64];
+    FILE* file;
+    int failures = 0;
+
+    snprintf(path, sizeof(path), "%s/flush.txt", dir);
+    file = fopen(path, check ? "r" : "w");
+    if (file == NULL) {
+        printf("FAIL %s\n", path);
+        return 1;
+    }
+    for (size_t i = 0; i < FLUSH_CASE_COUNT; i++) {
+        char line[64];
+        uint32_t full;
+        uint32_t changed;
+
+        flush_cases[i].render();
+        ssd1306_Invalidate();
+        full = flush_bytes();
+        flush_cases[i].change();
+        flush_cases[i].render();
+        changed = flush_bytes();
+        flush_cases[i].change();
+
+        snprintf(line, sizeof(line), "%s %lu %lu\n", flush_cases[i].name, (unsigned long)full, (unsigned long)changed);
+        if (!check) {
+            fputs(line, file);
+        } else if (fgets(expected, sizeof(expected), file) == NULL || strcmp(expected, line)) {
+            printf("FAIL %s: %s", path, line);
+            failures++;
+        } else {
+            printf("ok   %s: %s", path, line);
+        }
+    }
+    fclose(file);
+    return failures;
+}
+
+/*
+ * Encoder interrupts firing while a frame is drawn. Before the input
+ * queue the interrupt moved the menu itself; now it queues the event and
+ * the timer handler runs it before the next frame
+ */
+static Input_Queue_t frame_queue;
+static uint8_t frame_direct;        // 1: the interrupt moves the menu, as before the queue
+static uint8_t frame_armed;         // The interrupt fires at the next hook of the frame
+static uint32_t frame_tick;
+
+static void frame_interrupt(void) {
+    if (!frame_armed) {
+        return;
+    }
+    frame_armed = 0;
+    if (frame_direct) {
+        Menu_Turn(1);
+    } else {
+        // One detent clockwise; the firmware queues the pin levels for Rotary_Decode
+        Input_Push(&frame_queue, 0, 1, frame_tick);
+    }
+}
+
+/* Frames drawn with an interrupt each, that match no whole frame of the list */
+static uint32_t frame_count_torn(const uint8_t (*whole)[SSD1306_BUFFER_SIZE], uint8_t count, uint32_t ticks) {
+    const SSD1306_Target_t* screen = ssd1306_GetScreenTarget();
+    uint32_t torn = 0;
+
+    Screens_Init();
+    Menu_Set_Screen(MENU_SETTINGS, 0);
+    for (frame_tick = 0; frame_tick < ticks; frame_tick++) {
+        const Input_Event_t* event;
+        uint8_t match = 0;
+
+        // Order of Timer_Interrupt_Handler: the queued inputs, then the frame
+        while ((event = Input_Peek(&frame_queue)) != NULL) {
+            Menu_Turn(1);
+            Input_Pop(&frame_queue);
+        }
+        frame_armed = 1;
+        Display_Current_Menu();
+        ssd1306_UpdateScreenAsync();
+        // An interrupt that found no hook in this frame fires between two frames
+        frame_interrupt();
+
+        for (uint8_t i = 0; i < count && !match; i++) {
+            match = !memcmp(screen->buffer, whole[i], SSD1306_BUFFER_SIZE);
+        }
+        torn += !match;
+    }
+    return torn;
+}
+
+/*
+ * Show that a frame flushed while the encoder turns is always a whole
+ * frame of the settings list, and that the check sees the torn frames
+ * the interrupt caused when it moved the menu itself
+ */
+static int frame_check(uint32_t ticks) {
+    static uint8_t whole[5][SSD1306_BUFFER_SIZE];
+    uint32_t queued;
+    uint32_t direct;
+
+    for (uint8_t i = 0; i < 5; i++) {
+        host_show(MENU_SETTINGS, i);
+        memcpy(whole[i], ssd1306_GetScreenTarget()->buffer, SSD1306_BUFFER_SIZE);
+    }
+    frame_direct = 0;
+    queued = frame_count_torn(whole, 5, ticks);
+    frame_direct = 1;
+    direct = frame_count_torn(whole, 5, ticks);
+
+    printf("%s frames: %lu torn of %lu with queued input, %lu with the menu moved by the interrupt\n",
+           (queued == 0 && direct > 0) ? "ok  " : "FAIL", (unsigned long)queued, (unsigned long)ticks,
+           (unsigned long)direct);
+    return (queued == 0 && direct > 0) ? 0 : 1;
+}
+
+/* Bresenham outline of the driver before the midpoint walk */
+static void reference_draw_circle(uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR par_color) {
+    int32_t x = -par_r;
+    int32_t y = 0;
+    int32_t err = 2 - 2 * par_r;
+    int32_t e2;
+
+    if (par_x >= ssd1306_GetTarget()->width || par_y >= ssd1306_GetTarget()->height) {
+        return;
+    }
+
+    do {
+        ssd1306_DrawPixel(par_x - x, par_y + y, par_color);
+        ssd1306_DrawPixel(par_x + x, par_y + y, par_color);
+        ssd1306_DrawPixel(par_x + x, par_y - y, par_color);
+        ssd1306_DrawPixel(par_x - x, par_y - y, par_color);
+        e2 = err;
+
+        if (e2 <= y) {
+            y++;
+            err = err + (y * 2 + 1);
+            if (-x == y && e2 <= x) {
+                e2 = 0;
+            }
+        }
+
+        if (e2 > x) {
+            x++;
+            err = err + (x * 2 + 1);
+        }
+    } while (x <= 0);
+}
+
+/* Filled circle of the driver before the midpoint walk, one rectangle per outline step */
+static void reference_fill_circle(uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR par_color) {
+    int32_t x = -par_r;
+    int32_t y = 0;
+    int32_t err = 2 - 2 * par_r;
+    int32_t e2;
+
+    if (par_x >= ssd1306_GetTarget()->width || par_y >= ssd1306_GetTarget()->height) {
+        return;
+    }
+
+    do {
+        ssd1306_FillRectangle((par_x + x < 0) ? 0 : par_x + x, (par_y - y < 0) ? 0 : par_y - y,
+                              par_x - x, par_y + y, par_color);
+
+        e2 = err;
+        if (e2 <= y) {
+            y++;
+            err = err + (y * 2 + 1);
+            if (-x == y && e2 <= x) {
+                e2 = 0;
+            }
+        }
+
+        if (e2 > x) {
+            x++;
+            err = err + (x * 2 + 1);
+        }
+    } while (x <= 0);
+}
+
+/* Filled rectangle of the driver before the byte spans, one DrawPixel per pixel */
+static void reference_fill_rectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    uint8_t x_start = ((x1 <= x2) ? x1 : x2);
+    uint8_t x_end   = ((x1 <= x2) ? x2 : x1);
+    uint8_t y_start = ((y1 <= y2) ? y1 : y2);
+    uint8_t y_end   = ((y1 <= y2) ? y2 : y1);
+
+    for (uint8_t y = y_start; (y <= y_end) && (y < ssd1306_GetTarget()->height); y++) {
+        for (uint8_t x = x_start; (x <= x_end) && (x < ssd1306_GetTarget()->width); x++) {
+            ssd1306_DrawPixel(x, y, color);
+        }
+    }
+}
+
+/*
+ * Text of the driver before the byte blitter: one DrawPixel per pixel of
+ * the glyph box, lit or dark. The old fonts held rows of 16 bits; this
+ * reads the same bits from the column-major glyphs
+ */
+static char reference_write_char(uint8_t x, uint8_t y, char ch, FontDef Font, SSD1306_COLOR color) {
+    uint8_t pages = (Font.FontHeight + 7) / 8;
+    const uint8_t* glyph;
+    uint8_t index;
+
+    if (ch < 32 || ch > 126) {
+        return 0;
+    }
+    index = ch - 32;
+    if (Font.map != NULL) {
+        index = Font.map[index];
+        if (index == SSD1306_GLYPH_MISSING) {
+            return 0;
+        }
+    }
+    if (ssd1306_GetTarget()->width < x + Font.FontWidth || ssd1306_GetTarget()->height < y + Font.FontHeight) {
+        return 0;
+    }
+
+    glyph = &Font.data[index * Font.FontWidth * pages];
+    for (uint8_t i = 0; i < Font.FontHeight; i++) {
+        for (uint8_t j = 0; j < Font.FontWidth; j++) {
+            if ((glyph[(i / 8) * Font.FontWidth + j] >> (i % 8)) & 1) {
+                ssd1306_DrawPixel(x + j, y + i, color);
+            } else {
+                ssd1306_DrawPixel(x + j, y + i, (SSD1306_COLOR)!color);
+            }
+        }
+    }
+    return ch;
+}
+
+/* The cursor of the driver is its own, the reference string takes its position */
+static void reference_write_string(uint8_t x, uint8_t y, char* str, FontDef Font, SSD1306_COLOR color) {
+    while (*str && reference_write_char(x, y, *str, Font, color) == *str) {
+        x += Font.FontWidth;
+        str++;
+    }
+}
+
+static void bench_fill_10(void) { ssd1306_FillCircle(64, 16, 10, White); }
+static void bench_fill_10_ref(void) { reference_fill_circle(64, 16, 10, White); }
+static void bench_fill_28(void) { ssd1306_FillCircle(64, 31, 28, White); }
+static void bench_fill_28_ref(void) { reference_fill_circle(64, 31, 28, White); }
+static void bench_circle_28(void) { ssd1306_DrawCircle(64, 31, 28, White); }
+static void bench_circle_28_ref(void) { reference_draw_circle(64, 31, 28, White); }
+static void bench_gauge(void) { ssd1306_DrawArc(30, 31, 28, 90, 270, White); }
+static void bench_gauge_ref(void) { ssd1306_DrawArcFloat(30, 31, 28, 90, 270, White); }
+static void bench_needle(void) { ssd1306_DrawArcWithRadiusLine(64, 16, 14, 37, 113, White); }
+static void bench_needle_ref(void) { ssd1306_DrawArcWithRadiusLineFloat(64, 16, 14, 37, 113, White); }
+// FillSpan is private to the driver: one whole page row is a single span
+static void bench_span(void) { ssd1306_FillRectangle(0, 8, 127, 15, White); }
+static void bench_span_ref(void) { reference_fill_rectangle(0, 8, 127, 15, White); }
+// Both edges inside a page, as the bar meter and the graph areas
+static void bench_rectangle(void) { ssd1306_FillRectangle(10, 3, 100, 28, White); }
+static void bench_rectangle_ref(void) { reference_fill_rectangle(10, 3, 100, 28, White); }
+static void bench_hline(void) { ssd1306_DrawHLine(0, 127, 13, White); }
+static void bench_hline_ref(void) { reference_fill_rectangle(0, 13, 127, 13, White); }
+static void bench_vline(void) { ssd1306_DrawVLine(64, 1, 30, White); }
+static void bench_vline_ref(void) { reference_fill_rectangle(64, 1, 64, 30, White); }
+// Off the page grid, so every glyph straddles two pages
+static void bench_text_7x10(void) { ssd1306_SetCursor(2, 3); ssd1306_WriteString("P:15.38W", Font_7x10, White); }
+static void bench_text_7x10_ref(void) { reference_write_string(2, 3, "P:15.38W", Font_7x10, White); }
+static void bench_text_11x18(void) { ssd1306_SetCursor(2, 5); ssd1306_WriteString("12.3V", Font_11x18, White); }
+static void bench_text_11x18_ref(void) { reference_write_string(2, 5, "12.3V", Font_11x18, White); }
+static void bench_text_inverse(void) { ssd1306_SetCursor(0, 8); ssd1306_WriteString("> Settings", Font_6x8, Black); }
+static void bench_text_inverse_ref(void) { reference_write_string(0, 8, "> Settings", Font_6x8, Black); }
+
+typedef struct {
+    const char* name;
+    void (*current)(void);
+    void (*reference)(void);    // Previous per-pixel primitives, or the float arcs
+} Bench_Pair_t;
+
+static const Bench_Pair_t bench_pairs[] = {
+    { "FillCircle r=10", bench_fill_10, bench_fill_10_ref },
+    { "FillCircle r=28", bench_fill_28, bench_fill_28_ref },
+    { "DrawCircle r=28", bench_circle_28, bench_circle_28_ref },
+    { "gauge arc", bench_gauge, bench_gauge_ref },
+    { "arc + radius", bench_needle, bench_needle_ref },
+    { "span 1 page", bench_span, bench_span_ref },
+    { "FillRectangle", bench_rectangle, bench_rectangle_ref },
+    { "HLine", bench_hline, bench_hline_ref },
+    { "VLine", bench_vline, bench_vline_ref },
+    { "text 7x10", bench_text_7x10, bench_text_7x10_ref },
+    { "text 11x18", bench_text_11x18, bench_text_11x18_ref },
+    { "text inverse", bench_text_inverse, bench_text_inverse_ref },
+};
+#define BENCH_PAIR_COUNT (sizeof(bench_pairs) / sizeof(bench_pairs[0]))
+
+static double bench_time(void (*draw)(void), long count) {
+    clock_t start = clock();
+
+    for (long n = 0; n < count; n++) {
+        draw();
+    }
+    return (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / count;
+}
+
+/* Screenbuffer drawn by one function on a cleared screen */
+static void bench_draw(void (*draw)(void), uint8_t* out) {
+    const SSD1306_Target_t* screen = ssd1306_GetScreenTarget();
+
+    ssd1306_Fill(Black);
+    draw();
+    memcpy(out, screen->buffer, SSD1306_BUFFER_SIZE);
+}
+
+/*
+ * Time each circle, arc, fill and text primitive against the one it
+ * replaced and tell whether they draw the same pixels. The arcs are
+ * compared with the float versions, which draw segments and so differ by
+ * design
+ */
+static void bench_primitives(long count) {
+    static uint8_t current[SSD1306_BUFFER_SIZE];
+    static uint8_t reference[SSD1306_BUFFER_SIZE];
+
+    printf("%-16s %10s %10s  pixels differing\n", "", "us/draw", "previous");
+    for (size_t i = 0; i < BENCH_PAIR_COUNT; i++) {
+        uint32_t differing = 0;
+
+        bench_draw(bench_pairs[i].current, current);
+        bench_draw(bench_pairs[i].reference, reference);
+        for (size_t b = 0; b < SSD1306_BUFFER_SIZE; b++) {
+            differing += __builtin_popcount(current[b] ^ reference[b]);
+        }
+        printf("%-16s %10.3f %10.3f  %lu\n", bench_pairs[i].name,
+               bench_time(bench_pairs[i].current, count), bench_time(bench_pairs[i].reference, count),
+               (unsigned long)differing);
+    }
+}
+
+/* Encode a target as a binary PBM image */
+static size_t target_to_pbm(const SSD1306_Target_t* target, uint8_t* out, size_t size) {
+    size_t row_bytes = (target->width + 7) / 8;
+    int length = snprintf((char*)out, size, "P4\n%u %u\n", target->width, target->height);
+    size_t pos = (size_t)length;
+
+    if (length < 0 || pos + row_bytes * target->height > size) {
+        return 0;
+    }
+    memset(&out[pos], 0, row_bytes * target->height);
+    for (uint8_t y = 0; y < target->height; y++, pos += row_bytes) {
+        for (uint8_t x = 0; x < target->width; x++) {
+            uint8_t lit = target->buffer[(y / 8) * target->width + x] & (1 << (y % 8));
+
+            // PBM 1 is black, the dark pixels of the display
+            if (!lit) {
+                out[pos + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+    return pos;
+}
+
+int main(int argc, char** argv) {
+    const char* dir = "out";
+    const char* check = NULL;
+    long bench = 0;
+    int failures = 0;
+    static uint8_t image[64 + SSD1306_BUFFER_SIZE];
+    static uint8_t golden[sizeof(image)];
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (!strcmp(argv[i], "--check") && i + 1 < argc) {
+            check = argv[++i];
+        } else if (!strcmp(argv[i], "--bench") && i + 1 < argc) {
+            bench = strtol(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-o DIR] [--check DIR] [--bench N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ssd1306_Init();
+    host_record_inputs();
+
+    for (size_t s = 0; s < SCENE_COUNT; s++) {
+        char path[512];
+        size_t length;
+        FILE* file;
+
+        if (bench > 0) {
+            clock_t start = clock();
+
+            for (long n = 0; n < bench; n++) {
+                scenes[s].render();
+            }
+            printf("%-16s %8.2f us/render\n", scenes[s].name,
+                   (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / bench);
+            continue;
+        }
+
+        scenes[s].render();
+        length = target_to_pbm(ssd1306_GetScreenTarget(), image, sizeof(image));
+        snprintf(path, sizeof(path), "%s/%s.pbm", check ? check : dir, scenes[s].name);
+
+        if (check) {
+            file = fopen(path, "rb");
+            if (file == NULL || fread(golden, 1, sizeof(golden), file) != length || memcmp(golden, image, length)) {
+                printf("FAIL %s\n", path);
+                failures++;
+            } else {
+                printf("ok   %s\n", path);
+            }
+        } else {
+            file = fopen(path, "wb");
+            if (file == NULL || fwrite(image, 1, length, file) != length) {
+                fprintf(stderr, "cannot write %s\n", path);
+                failures++;
+            }
+        }
+        if (file) {
+            fclose(file);
+        }
+    }
+    if (bench > 0) {
+        bench_primitives(bench);
+    } else {
+        failures += flush_check(check ? check : dir, check != NULL);
+        failures += frame_check(100);
+    }
+    return failures ? 1 : 0;
+}
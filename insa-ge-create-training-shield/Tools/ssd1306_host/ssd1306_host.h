@@ -0,0 +1,38 @@
+/*
+ * HAL declarations for the host build of the SSD1306 drawing code.
+ * ssd1306.h includes this file instead of the STM32 HAL when
+ * SSD1306_HOST is defined; snapshot.c provides the functions.
+ */
+
+#ifndef __SSD1306_HOST_H__
+#define __SSD1306_HOST_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+#define _BEGIN_STD_C extern "C" {
+#define _END_STD_C   }
+#else
+#define _BEGIN_STD_C
+#define _END_STD_C
+#endif
+
+typedef enum {
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+typedef struct {
+    uint32_t bytes;     // Bytes written to the simulated display
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                        uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+#endif /* __SSD1306_HOST_H__ */
@@ -0,0 +1,14 @@
+/*
+ * Stand-in for the STM32 HAL header in the host build. main.h and
+ * i2c_timing.h include it for the firmware screens and the input queue;
+ * the declarations they use are those of ssd1306_host.h.
+ */
+
+#ifndef __STM32L0xx_HAL_H
+#define __STM32L0xx_HAL_H
+
+#include "ssd1306_host.h"
+
+#define __DMB() __sync_synchronize()
+
+#endif /* __STM32L0xx_HAL_H */